@@ -3,3 +3,10 @@ def can_build(env, platform):
 
 def configure(env):
     pass
+
+def get_opts(platform):
+    from SCons.Variables import BoolVariable
+
+    return [
+        BoolVariable("noise_composer_profiling", "Build the per node profiling of noise graphs, enabled at runtime with NoiseNode.set_profiling_enabled()", True),
+    ]
@@ -0,0 +1,396 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_baked.h"
+
+#include "core/math/math_funcs.h"
+
+// Coordinates of the queried points, as many as the dimension of the query.
+static inline int _get_point_dimension(const real_t *) { return 1; }
+static inline int _get_point_dimension(const Vector2 *) { return 2; }
+static inline int _get_point_dimension(const Vector3 *) { return 3; }
+
+static inline void _get_point_coords(real_t p_x, real_t *r_coords) { r_coords[0] = p_x; }
+static inline void _get_point_coords(const Vector2 &p_v, real_t *r_coords) {
+	r_coords[0] = p_v.x;
+	r_coords[1] = p_v.y;
+}
+static inline void _get_point_coords(const Vector3 &p_v, real_t *r_coords) {
+	r_coords[0] = p_v.x;
+	r_coords[1] = p_v.y;
+	r_coords[2] = p_v.z;
+}
+
+// Interpolation between p_samples[1] and p_samples[2], the samples around them being p_samples[0] and p_samples[3].
+static real_t _interpolate(const real_t *p_samples, real_t p_weight, BakedNoise::Interpolation p_interpolation) {
+	switch (p_interpolation) {
+		case BakedNoise::INTERPOLATION_CUBIC:
+			return Math::cubic_interpolate(p_samples[1], p_samples[2], p_samples[0], p_samples[3], p_weight);
+		case BakedNoise::INTERPOLATION_HERMITE: {
+			// Tangents are the harmonic means of the neighbouring slopes, zero at extrema (Fritsch-Butland).
+			const real_t before = p_samples[1] - p_samples[0];
+			const real_t slope = p_samples[2] - p_samples[1];
+			const real_t after = p_samples[3] - p_samples[2];
+			const real_t from_tangent = (before * slope) > 0. ? (2. * before * slope) / (before + slope) : 0.;
+			const real_t to_tangent = (slope * after) > 0. ? (2. * slope * after) / (slope + after) : 0.;
+			const real_t t2 = p_weight * p_weight;
+			const real_t t3 = t2 * p_weight;
+			return ((2. * t3 - 3. * t2 + 1.) * p_samples[1]) + ((t3 - 2. * t2 + p_weight) * from_tangent) + ((3. * t2 - 2. * t3) * p_samples[2]) + ((t3 - t2) * to_tangent);
+		}
+		default:
+			return p_samples[1] + ((p_samples[2] - p_samples[1]) * p_weight);
+	}
+}
+
+bool BakedNoise::Grid::locate(const real_t *p_point, real_t *r_coords) const {
+	const real_t last = resolution - 1;
+	for (int axis = 0; axis < dimension; ++axis) {
+		const real_t coord = ((p_point[axis] - domain.position[axis]) * last) / domain.size[axis];
+		if (!(coord >= 0. && coord <= last)) {
+			return false;
+		}
+		r_coords[axis] = coord;
+	}
+	return true;
+}
+
+real_t BakedNoise::Grid::sample(const real_t *p_coords) const {
+	int base[3];
+	real_t fraction[3];
+	for (int axis = 0; axis < dimension; ++axis) {
+		base[axis] = MIN((int)p_coords[axis], resolution - 2);
+		fraction[axis] = p_coords[axis] - base[axis];
+	}
+	return _sample_axis(dimension - 1, base, fraction, 0);
+}
+
+// Interpolation along one axis of the values interpolated along the previous axes.
+real_t BakedNoise::Grid::_sample_axis(int p_axis, const int *p_base, const real_t *p_fraction, int p_offset) const {
+	int stride = 1;
+	for (int axis = 0; axis < p_axis; ++axis) {
+		stride *= resolution;
+	}
+	// Samples beyond the edges of the grid are extrapolated linearly.
+	const int from = interpolation == INTERPOLATION_LINEAR || p_base[p_axis] == 0 ? 1 : 0;
+	const int to = interpolation == INTERPOLATION_LINEAR || p_base[p_axis] + 2 >= resolution ? 3 : 4;
+	real_t samples[4] = { 0., 0., 0., 0. };
+	for (int i = from; i < to; ++i) {
+		const int offset = p_offset + ((p_base[p_axis] + i - 1) * stride);
+		samples[i] = p_axis == 0 ? values[offset] : _sample_axis(p_axis - 1, p_base, p_fraction, offset);
+	}
+	if (interpolation != INTERPOLATION_LINEAR) {
+		samples[0] = from == 0 ? samples[0] : (2. * samples[1]) - samples[2];
+		samples[3] = to == 4 ? samples[3] : (2. * samples[2]) - samples[1];
+	}
+	return _interpolate(samples, p_fraction[p_axis], interpolation);
+}
+
+// Passes finishing meanwhile lock the queue to publish, it is not held while waiting for them.
+BakedNoise::~BakedNoise() {
+	generation.fetch_add(1, std::memory_order_acq_rel);
+	_reap_passes(true);
+}
+
+void BakedNoise::set_source(Ref<Noise> n) {
+	if (source.is_valid()) {
+		source->disconnect_changed(callable_mp(this, &BakedNoise::_source_changed));
+	}
+	source = n;
+	if (source.is_valid()) {
+		source->connect_changed(callable_mp(this, &BakedNoise::_source_changed));
+	}
+	_notify_changed();
+}
+
+void BakedNoise::set_dimension(Dimension p_dimension) {
+	dimension = p_dimension;
+	_notify_changed();
+}
+
+void BakedNoise::set_domain(const AABB &p_domain) {
+	domain = p_domain.abs();
+	_notify_changed();
+}
+
+void BakedNoise::set_resolution(int p_resolution) {
+	resolution = MAX(2, p_resolution);
+	_notify_changed();
+}
+
+void BakedNoise::set_interpolation(Interpolation p_interpolation) {
+	interpolation = p_interpolation;
+	_notify_changed();
+}
+
+template <typename P>
+void BakedNoise::_sample(const P *p_points, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	const NoiseDoubleBuffer<Grid>::Reader grid = grids.read();
+	if (grid->dimension != _get_point_dimension(p_points)) {
+		sample_batch(source, p_points, r_values, p_count);
+		return;
+	}
+	// Points outside of the grid are gathered and sampled from the source.
+	P outside[BATCH_SIZE];
+	real_t values[BATCH_SIZE];
+	int lanes[BATCH_SIZE];
+	for (int offset = 0; offset < p_count; offset += BATCH_SIZE) {
+		const int block = MIN(BATCH_SIZE, p_count - offset);
+		int outside_count = 0;
+		for (int i = offset; i < offset + block; ++i) {
+			real_t point[3], coords[3];
+			_get_point_coords(p_points[i], point);
+			if (grid->locate(point, coords)) {
+				r_values[i] = grid->sample(coords);
+			} else {
+				outside[outside_count] = p_points[i];
+				lanes[outside_count++] = i;
+			}
+		}
+		if (outside_count > 0) {
+			sample_batch(source, outside, values, outside_count);
+			for (int i = 0; i < outside_count; ++i) {
+				r_values[lanes[i]] = values[i];
+			}
+		}
+	}
+}
+
+real_t BakedNoise::get_noise_1d(real_t p_x) const {
+	real_t value;
+	_sample(&p_x, &value, 1);
+	return value;
+}
+
+real_t BakedNoise::get_noise_2dv(Vector2 p_v) const {
+	real_t value;
+	_sample(&p_v, &value, 1);
+	return value;
+}
+real_t BakedNoise::get_noise_2d(real_t p_x, real_t p_y) const {
+	return get_noise_2dv(Vector2(p_x, p_y));
+}
+
+real_t BakedNoise::get_noise_3dv(Vector3 p_v) const {
+	real_t value;
+	_sample(&p_v, &value, 1);
+	return value;
+}
+real_t BakedNoise::get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const {
+	return get_noise_3dv(Vector3(p_x, p_y, p_z));
+}
+
+void BakedNoise::get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const {
+	_sample(p_x, r_values, p_count);
+}
+
+void BakedNoise::get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	_sample(p_v, r_values, p_count);
+}
+
+void BakedNoise::get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	_sample(p_v, r_values, p_count);
+}
+
+// Bake started by a change. Rows of the grid, along its first axis, are spread over the worker thread pool,
+// and the last row to complete publishes the grid.
+struct BakedNoise::BakePass {
+	uint64_t generation{ 0 };
+	Ref<Noise> source;
+	Grid grid;
+	int rows{ 0 };
+	std::atomic<int> completed{ 0 };
+	WorkerThreadPool::GroupID group{ -1 };
+};
+
+void BakedNoise::_bake_row(uint32_t p_row, BakePass *p_pass) {
+	const Grid &grid = p_pass->grid;
+	const int row_y = p_row % grid.resolution;
+	const int row_z = p_row / grid.resolution;
+	const Vector3 cell = grid.domain.size / (grid.resolution - 1);
+	real_t *row = p_pass->grid.values.ptr() + (p_row * grid.resolution);
+
+	real_t xs[BATCH_SIZE];
+	Vector2 points_2d[BATCH_SIZE];
+	Vector3 points_3d[BATCH_SIZE];
+	for (int offset = 0; offset < grid.resolution; offset += BATCH_SIZE) {
+		if (generation.load(std::memory_order_relaxed) != p_pass->generation) {
+			break;
+		}
+		const int chunk = MIN(BATCH_SIZE, grid.resolution - offset);
+		for (int i = 0; i < chunk; ++i) {
+			points_3d[i] = grid.domain.position + (cell * Vector3(offset + i, row_y, row_z));
+		}
+		switch (grid.dimension) {
+			case 1:
+				for (int i = 0; i < chunk; ++i) {
+					xs[i] = points_3d[i].x;
+				}
+				sample_batch(p_pass->source, xs, row + offset, chunk);
+				break;
+			case 2:
+				for (int i = 0; i < chunk; ++i) {
+					points_2d[i] = Vector2(points_3d[i].x, points_3d[i].y);
+				}
+				sample_batch(p_pass->source, points_2d, row + offset, chunk);
+				break;
+			default:
+				sample_batch(p_pass->source, points_3d, row + offset, chunk);
+				break;
+		}
+	}
+	if (p_pass->completed.fetch_add(1, std::memory_order_acq_rel) + 1 == p_pass->rows) {
+		_publish(p_pass);
+	}
+}
+
+// The grid moves into the buffer, and the one published before is released once no reader holds it, so that
+// a single grid stays resident besides the ones being baked.
+void BakedNoise::_publish(BakePass *p_pass) {
+	{
+		// Bakes bump the generation with the lock held, so none can store its grid in between.
+		MutexLock lock(queue_mutex);
+		if (generation.load(std::memory_order_acquire) != p_pass->generation) {
+			p_pass->grid = Grid();
+			return;
+		}
+		grids.write([&](Grid &r_grid) { SWAP(r_grid, p_pass->grid); });
+		working.store(false, std::memory_order_release);
+	}
+	p_pass->grid = Grid();
+	grids.write_unpublished([](Grid &r_grid) { r_grid = Grid(); });
+	// Queued by id, as the node may be freed before the call runs.
+	callable_mp_static(&BakedNoise::_finish_bake).call_deferred(get_instance_id());
+}
+
+// Runs on the main thread once a pass published its grid. Passes whose tasks are over are freed there, the
+// others by a later bake or the destructor.
+void BakedNoise::_finish_bake(ObjectID p_id) {
+	Ref<BakedNoise> baked = Object::cast_to<BakedNoise>(ObjectDB::get_instance(p_id));
+	if (baked.is_null()) {
+		return;
+	}
+	baked->queue_mutex.lock();
+	baked->_reap_passes(false);
+	baked->queue_mutex.unlock();
+	baked->emit_changed();
+}
+
+void BakedNoise::_reap_passes(bool p_wait) {
+	for (uint32_t i = 0; i < passes.size();) {
+		BakePass *pass = passes[i];
+		if (p_wait || WorkerThreadPool::get_singleton()->is_group_task_completed(pass->group)) {
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(pass->group);
+			memdelete(pass);
+			passes.remove_at_unordered(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void BakedNoise::queue_bake() {
+	queue_mutex.lock();
+	// Stale passes notice the new generation and stop, they are collected by a later bake.
+	const uint64_t current = generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+	_reap_passes(false);
+
+	const int baked_dimension = int(dimension) + 1;
+	bool empty = source.is_null();
+	for (int axis = 0; axis < baked_dimension; ++axis) {
+		empty = empty || domain.size[axis] <= 0.;
+	}
+	if (empty) {
+		grids.write([](Grid &r_grid) { r_grid = Grid(); });
+		working.store(false, std::memory_order_release);
+		queue_mutex.unlock();
+		emit_changed();
+		return;
+	}
+
+	BakePass *pass = memnew(BakePass);
+	pass->generation = current;
+	pass->source = source;
+	pass->grid.domain = domain;
+	pass->grid.dimension = baked_dimension;
+	pass->grid.resolution = resolution;
+	pass->grid.interpolation = interpolation;
+	pass->rows = 1;
+	for (int axis = 1; axis < baked_dimension; ++axis) {
+		pass->rows *= resolution;
+	}
+	pass->grid.values.resize(pass->rows * resolution);
+	working.store(true, std::memory_order_release);
+	pass->group = WorkerThreadPool::get_singleton()->add_template_group_task(
+			this, &BakedNoise::_bake_row, pass, pass->rows, -1, false, SNAME("BakedNoise"));
+	passes.push_back(pass);
+	queue_mutex.unlock();
+}
+
+real_t BakedNoise::get_progress() const {
+	MutexLock lock(queue_mutex);
+	if (!is_working() || passes.is_empty()) {
+		return 1.;
+	}
+	const BakePass *pass = passes[passes.size() - 1];
+	for (const BakePass *p : passes) {
+		if (p->generation > pass->generation) {
+			pass = p;
+		}
+	}
+	return (real_t)pass->completed.load(std::memory_order_relaxed) / pass->rows;
+}
+
+void BakedNoise::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_source", "n"), &BakedNoise::set_source);
+	ClassDB::bind_method(D_METHOD("get_source"), &BakedNoise::get_source);
+
+	ClassDB::bind_method(D_METHOD("set_dimension", "dimension"), &BakedNoise::set_dimension);
+	ClassDB::bind_method(D_METHOD("get_dimension"), &BakedNoise::get_dimension);
+
+	ClassDB::bind_method(D_METHOD("set_domain", "domain"), &BakedNoise::set_domain);
+	ClassDB::bind_method(D_METHOD("get_domain"), &BakedNoise::get_domain);
+
+	ClassDB::bind_method(D_METHOD("set_resolution", "resolution"), &BakedNoise::set_resolution);
+	ClassDB::bind_method(D_METHOD("get_resolution"), &BakedNoise::get_resolution);
+
+	ClassDB::bind_method(D_METHOD("set_interpolation", "interpolation"), &BakedNoise::set_interpolation);
+	ClassDB::bind_method(D_METHOD("get_interpolation"), &BakedNoise::get_interpolation);
+
+	ClassDB::bind_method(D_METHOD("is_working"), &BakedNoise::is_working);
+	ClassDB::bind_method(D_METHOD("get_progress"), &BakedNoise::get_progress);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "source", PROPERTY_HINT_RESOURCE_TYPE, "Noise"), "set_source", "get_source");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "dimension", PROPERTY_HINT_ENUM, "1D,2D,3D"), "set_dimension", "get_dimension");
+	ADD_PROPERTY(PropertyInfo(Variant::AABB, "domain"), "set_domain", "get_domain");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "resolution", PROPERTY_HINT_RANGE, "2,1024,1"), "set_resolution", "get_resolution");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "interpolation", PROPERTY_HINT_ENUM, "Linear,Cubic,Hermite"), "set_interpolation", "get_interpolation");
+
+	BIND_ENUM_CONSTANT(DIMENSION_1D);
+	BIND_ENUM_CONSTANT(DIMENSION_2D);
+	BIND_ENUM_CONSTANT(DIMENSION_3D);
+
+	BIND_ENUM_CONSTANT(INTERPOLATION_LINEAR);
+	BIND_ENUM_CONSTANT(INTERPOLATION_CUBIC);
+	BIND_ENUM_CONSTANT(INTERPOLATION_HERMITE);
+}
@@ -0,0 +1,154 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_BAKED_H
+#define NOISE_BAKED_H
+
+#include "core/math/aabb.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+#include "noise_base.h"
+#include "noise_sync.h"
+#include <atomic>
+
+// Noise answering queries by interpolating its source, sampled once over a regular grid covering a domain.
+// Meant for expensive, low frequency sources. Queries of another dimension than the baked one, or outside
+// of the domain, are answered by the source itself. The grid is baked again in the background whenever the
+// source or the settings change; until then, queries keep using the previous grid.
+class BakedNoise : public NoiseNode {
+	GDCLASS(BakedNoise, NoiseNode)
+	OBJ_SAVE_TYPE(BakedNoise)
+
+public:
+	enum Dimension {
+		DIMENSION_1D,
+		DIMENSION_2D,
+		DIMENSION_3D,
+	};
+
+	enum Interpolation {
+		INTERPOLATION_LINEAR,
+		// Catmull-Rom spline, smooth but overshooting the samples.
+		INTERPOLATION_CUBIC,
+		// Monotonic cubic Hermite spline, smooth and staying between the samples.
+		INTERPOLATION_HERMITE,
+	};
+
+public:
+	BakedNoise() :
+			NoiseNode(1) {}
+	virtual ~BakedNoise();
+
+	void set_source(Ref<Noise> n);
+	Ref<Noise> get_source() const { return source; }
+
+	void set_dimension(Dimension p_dimension);
+	Dimension get_dimension() const { return dimension; }
+
+	void set_domain(const AABB &p_domain);
+	AABB get_domain() const { return domain; }
+
+	// Number of samples along each axis of the grid.
+	void set_resolution(int p_resolution);
+	int get_resolution() const { return resolution; }
+
+	void set_interpolation(Interpolation p_interpolation);
+	Interpolation get_interpolation() const { return interpolation; }
+
+	bool is_working() const { return working.load(std::memory_order_acquire); }
+	// Completion of the running bake, between 0 and 1.
+	real_t get_progress() const;
+
+	virtual real_t get_noise_1d(real_t p_x) const override;
+
+	virtual real_t get_noise_2dv(Vector2 p_v) const override;
+	virtual real_t get_noise_2d(real_t p_x, real_t p_y) const override;
+
+	virtual real_t get_noise_3dv(Vector3 p_v) const override;
+	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override;
+
+	virtual void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const override;
+	virtual void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override;
+	virtual void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override;
+
+	virtual Ref<Noise> get_child(int) const override { return source; }
+
+	// A grid may lag behind its source, interpolated values are never strictly bounded.
+	virtual NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override {
+		return p_strict ? NoiseInterval() : get_interval(source, p_region, false);
+	}
+
+protected:
+	static void _bind_methods();
+
+	// Changes of the source or of the settings start a new bake, which notifies the change once done.
+	void _source_changed() { _notify_changed(); }
+	virtual void _flush_changed() override { queue_bake(); }
+
+private:
+	struct Grid {
+		LocalVector<real_t> values;
+		AABB domain;
+		// Number of coordinates of the baked queries, 0 when nothing is baked.
+		int dimension{ 0 };
+		int resolution{ 0 };
+		Interpolation interpolation{ INTERPOLATION_LINEAR };
+
+		// Grid coordinates of a point, false when outside of the grid.
+		bool locate(const real_t *p_point, real_t *r_coords) const;
+		real_t sample(const real_t *p_coords) const;
+
+	private:
+		real_t _sample_axis(int p_axis, const int *p_base, const real_t *p_fraction, int p_offset) const;
+	};
+
+	struct BakePass;
+
+	template <typename P>
+	void _sample(const P *p_points, real_t *r_values, int p_count) const;
+	void _bake_row(uint32_t p_row, BakePass *p_pass);
+	void _publish(BakePass *p_pass);
+	static void _finish_bake(ObjectID p_id);
+	void _reap_passes(bool p_wait);
+	void queue_bake();
+
+private:
+	Ref<Noise> source;
+	Dimension dimension{ DIMENSION_2D };
+	AABB domain{ Vector3(), Vector3(256., 256., 256.) };
+	int resolution{ 128 };
+	Interpolation interpolation{ INTERPOLATION_LINEAR };
+
+	NoiseDoubleBuffer<Grid> grids;
+	// Bumped by every bake, the passes started for an older generation stop sampling.
+	std::atomic<uint64_t> generation{ 0 };
+	std::atomic<bool> working{ false };
+	LocalVector<BakePass *> passes;
+	Mutex queue_mutex;
+};
+
+VARIANT_ENUM_CAST(BakedNoise::Dimension);
+VARIANT_ENUM_CAST(BakedNoise::Interpolation);
+
+#endif
@@ -0,0 +1,790 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_base.h"
+#include "core/object/class_db.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/hashfuncs.h"
+#include "noise_program.h"
+
+void NoiseNode::get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = get_noise_1d(p_x[i]);
+	}
+}
+
+void NoiseNode::get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = get_noise_2d(p_v[i].x, p_v[i].y);
+	}
+}
+
+void NoiseNode::get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = get_noise_3d(p_v[i].x, p_v[i].y, p_v[i].z);
+	}
+}
+
+void NoiseNode::sample_batch(const Ref<Noise> &p_noise, const real_t *p_x, real_t *r_values, int p_count) {
+	if (p_noise.is_null()) {
+		std::fill(r_values, r_values + p_count, 0.);
+		return;
+	}
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	if (node) {
+		node->get_noise_1d_batch(p_x, r_values, p_count);
+		return;
+	}
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = p_noise->get_noise_1d(p_x[i]);
+	}
+}
+
+void NoiseNode::sample_batch(const Ref<Noise> &p_noise, const Vector2 *p_v, real_t *r_values, int p_count) {
+	if (p_noise.is_null()) {
+		std::fill(r_values, r_values + p_count, 0.);
+		return;
+	}
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	if (node) {
+		node->get_noise_2d_batch(p_v, r_values, p_count);
+		return;
+	}
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = p_noise->get_noise_2d(p_v[i].x, p_v[i].y);
+	}
+}
+
+void NoiseNode::sample_batch(const Ref<Noise> &p_noise, const Vector3 *p_v, real_t *r_values, int p_count) {
+	if (p_noise.is_null()) {
+		std::fill(r_values, r_values + p_count, 0.);
+		return;
+	}
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	if (node) {
+		node->get_noise_3d_batch(p_v, r_values, p_count);
+		return;
+	}
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = p_noise->get_noise_3d(p_v[i].x, p_v[i].y, p_v[i].z);
+	}
+}
+
+NoiseInterval NoiseNode::get_interval(const Ref<Noise> &p_noise, bool p_strict) {
+	return get_interval(p_noise, NoiseRegion(), p_strict);
+}
+
+NoiseInterval NoiseNode::get_interval(const Ref<Noise> &p_noise, const NoiseRegion &p_region, bool p_strict) {
+	if (p_noise.is_null()) {
+		return NoiseInterval::point(0.);
+	}
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	NoiseInterval result;
+	if (p_noise->has_meta(RANGE_META)) {
+		Vector2 range = p_noise->get_meta(RANGE_META);
+		result = NoiseInterval(MIN(range.x, range.y), MAX(range.x, range.y));
+	} else if (node) {
+		return node->get_region_interval(p_region, p_strict);
+	} else if (!p_strict) {
+		result = NoiseInterval(-1., 1.);
+	}
+	if (p_region.is_bounded() && p_noise->has_meta(LIPSCHITZ_META)) {
+		// The value at the center only drifts by the declared rate over the distance to the farthest point.
+		const real_t lipschitz = Math::abs(real_t(p_noise->get_meta(LIPSCHITZ_META)));
+		const Vector3 center = p_region.get_center();
+		real_t value = 0.;
+		switch (p_region.dimension) {
+			case 1:
+				value = p_noise->get_noise_1d(center.x);
+				break;
+			case 2:
+				value = p_noise->get_noise_2d(center.x, center.y);
+				break;
+			default:
+				value = p_noise->get_noise_3d(center.x, center.y, center.z);
+				break;
+		}
+		const real_t reach = lipschitz * p_region.get_radius();
+		result = NoiseInterval::intersection(result, NoiseInterval(value - reach, value + reach).widened());
+	}
+	return result;
+}
+
+// Values of a node over a grid of pixels, sampled in parallel tiles and then handed back to the
+// image generation of the base Noise class. Normalization, inversion and seamless blending stay
+// the ones of the engine, only the sampling is moved off the calling thread. Tiles are sampled through
+// a program built from the source, so that nodes shared in the graph are evaluated once per pixel. Each
+// tile builds its own program, pruned to the branches of the graph reachable over the tile.
+class NoiseNodePixelCache : public Noise {
+public:
+	static constexpr int TILE_SIZE = 64;
+
+	NoiseNodePixelCache() {}
+
+	void fill(const NoiseNode *p_source, int p_width, int p_height, int p_depth, bool p_in_3d_space) {
+		source = p_source;
+		width = p_width;
+		height = p_height;
+		depth = p_depth;
+		in_3d_space = p_in_3d_space;
+		tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+		values.resize(width * height * depth);
+
+		const int tile_count = tiles_x * tiles_y * depth;
+		if (tile_count == 1) {
+			_fill_tile(0, nullptr);
+			return;
+		}
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(
+				this, &NoiseNodePixelCache::_fill_tile, (void *)nullptr, tile_count, -1, true, SNAME("NoiseNodeImage"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+	}
+
+	virtual real_t get_noise_1d(real_t p_x) const override { return source->get_noise_1d(p_x); }
+
+	virtual real_t get_noise_2dv(Vector2 p_v) const override { return get_noise_2d(p_v.x, p_v.y); }
+	virtual real_t get_noise_2d(real_t p_x, real_t p_y) const override {
+		int index = in_3d_space ? -1 : _get_index(p_x, p_y, 0.);
+		return index >= 0 ? values[index] : source->get_noise_2d(p_x, p_y);
+	}
+
+	virtual real_t get_noise_3dv(Vector3 p_v) const override { return get_noise_3d(p_v.x, p_v.y, p_v.z); }
+	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override {
+		int index = in_3d_space ? _get_index(p_x, p_y, p_z) : -1;
+		return index >= 0 ? values[index] : source->get_noise_3d(p_x, p_y, p_z);
+	}
+
+private:
+	int _get_index(real_t p_x, real_t p_y, real_t p_z) const {
+		int x = p_x, y = p_y, z = p_z;
+		if (x != p_x || y != p_y || z != p_z || x < 0 || y < 0 || z < 0 || x >= width || y >= height || z >= depth) {
+			return -1;
+		}
+		return (((z * height) + y) * width) + x;
+	}
+
+	void _fill_tile(uint32_t p_index, void *) {
+		const int tile_x = p_index % tiles_x;
+		const int tile_y = (p_index / tiles_x) % tiles_y;
+		const int z = p_index / (tiles_x * tiles_y);
+		const int x0 = tile_x * TILE_SIZE;
+		const int y0 = tile_y * TILE_SIZE;
+		const int w = MIN(TILE_SIZE, width - x0);
+		const int h = MIN(TILE_SIZE, height - y0);
+
+		LocalVector<real_t> tile;
+		tile.resize(w * h);
+		const Ref<Noise> graph(const_cast<NoiseNode *>(source));
+		NoiseProgram program;
+		if (in_3d_space) {
+			program.build(graph, false, NoiseRegion::volume(AABB(Vector3(x0, y0, z), Vector3(w - 1, h - 1, 0.))));
+			LocalVector<Vector3> points;
+			points.resize(w * h);
+			for (int y = 0; y < h; ++y) {
+				for (int x = 0; x < w; ++x) {
+					points[(y * w) + x] = Vector3(x0 + x, y0 + y, z);
+				}
+			}
+			program.run_batch(points.ptr(), tile.ptr(), w * h);
+		} else {
+			program.build(graph, false, NoiseRegion::rect(Rect2(x0, y0, w - 1, h - 1)));
+			LocalVector<Vector2> points;
+			points.resize(w * h);
+			for (int y = 0; y < h; ++y) {
+				for (int x = 0; x < w; ++x) {
+					points[(y * w) + x] = Vector2(x0 + x, y0 + y);
+				}
+			}
+			program.run_batch(points.ptr(), tile.ptr(), w * h);
+		}
+		for (int y = 0; y < h; ++y) {
+			std::copy(tile.ptr() + (y * w), tile.ptr() + ((y + 1) * w), values.ptr() + _get_index(x0, y0 + y, z));
+		}
+	}
+
+private:
+	const NoiseNode *source{ nullptr };
+	int width{ 0 };
+	int height{ 0 };
+	int depth{ 0 };
+	int tiles_x{ 0 };
+	int tiles_y{ 0 };
+	bool in_3d_space{ false };
+	LocalVector<real_t> values;
+};
+
+Ref<Image> NoiseNode::get_image(int p_width, int p_height, bool p_invert, bool p_in_3d_space, bool p_normalize) const {
+	ERR_FAIL_COND_V(p_width <= 0 || p_height <= 0, Ref<Image>());
+	Ref<NoiseNodePixelCache> cache;
+	cache.instantiate();
+	cache->fill(this, p_width, p_height, 1, p_in_3d_space);
+	return cache->get_image(p_width, p_height, p_invert, p_in_3d_space, p_normalize);
+}
+
+Ref<Image> NoiseNode::get_seamless_image(int p_width, int p_height, bool p_invert, bool p_in_3d_space, real_t p_blend_skirt, bool p_normalize) const {
+	ERR_FAIL_COND_V(p_width <= 0 || p_height <= 0, Ref<Image>());
+	// Seamless images are blended from a larger source, including a skirt on each axis. The engine samples that
+	// source through get_image(), so in 3D space only at z = 0.
+	const int width = p_width + MAX(1, int(p_width * p_blend_skirt));
+	const int height = p_height + MAX(1, int(p_height * p_blend_skirt));
+	Ref<NoiseNodePixelCache> cache;
+	cache.instantiate();
+	cache->fill(this, width, height, 1, p_in_3d_space);
+	return cache->get_seamless_image(p_width, p_height, p_invert, p_in_3d_space, p_blend_skirt, p_normalize);
+}
+
+// Terrain maps of a grid of pixels. Heights are sampled once, in parallel tiles, over the pixels and an apron of
+// one pixel around them. The other maps are then derived row by row from the neighbouring heights.
+struct NoiseNodeTerrainPass {
+	static constexpr int TILE_SIZE = 64;
+
+	const NoiseNode *source{ nullptr };
+	Vector2 origin;
+	Vector2 step;
+	int width{ 0 };
+	int height{ 0 };
+	real_t height_scale{ 1. };
+	// Heights of the pixels and of the apron, by rows of width + 2.
+	LocalVector<real_t> heights;
+	int grid_width{ 0 };
+	int grid_height{ 0 };
+	int tiles_x{ 0 };
+	int tiles_y{ 0 };
+
+	float *height_map{ nullptr };
+	uint8_t *normal_map{ nullptr };
+	float *slope_map{ nullptr };
+	float *curvature_map{ nullptr };
+
+	void run() {
+		grid_width = width + 2;
+		grid_height = height + 2;
+		tiles_x = (grid_width + TILE_SIZE - 1) / TILE_SIZE;
+		tiles_y = (grid_height + TILE_SIZE - 1) / TILE_SIZE;
+		heights.resize(grid_width * grid_height);
+
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(
+				this, &NoiseNodeTerrainPass::_sample_tile, (void *)nullptr, tiles_x * tiles_y, -1, true, SNAME("NoiseNodeTerrainHeights"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+		group = WorkerThreadPool::get_singleton()->add_template_group_task(
+				this, &NoiseNodeTerrainPass::_derive_row, (void *)nullptr, height, -1, true, SNAME("NoiseNodeTerrainMaps"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+	}
+
+private:
+	void _sample_tile(uint32_t p_index, void *) {
+		const int x0 = (p_index % tiles_x) * TILE_SIZE;
+		const int y0 = (p_index / tiles_x) * TILE_SIZE;
+		const int w = MIN(TILE_SIZE, grid_width - x0);
+		const int h = MIN(TILE_SIZE, grid_height - y0);
+
+		// The first row and column of the grid are the apron, one step before the origin.
+		const Vector2 corner(origin.x + ((x0 - 1) * step.x), origin.y + ((y0 - 1) * step.y));
+		NoiseProgram program;
+		program.build(Ref<Noise>(const_cast<NoiseNode *>(source)), false, NoiseRegion::rect(Rect2(corner, Vector2((w - 1) * step.x, (h - 1) * step.y))));
+		LocalVector<Vector2> points;
+		LocalVector<real_t> tile;
+		points.resize(w * h);
+		tile.resize(w * h);
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				points[(y * w) + x] = Vector2(corner.x + (x * step.x), corner.y + (y * step.y));
+			}
+		}
+		program.run_batch(points.ptr(), tile.ptr(), w * h);
+		for (int y = 0; y < h; ++y) {
+			std::copy(tile.ptr() + (y * w), tile.ptr() + ((y + 1) * w), heights.ptr() + ((y0 + y) * grid_width) + x0);
+		}
+	}
+
+	void _derive_row(uint32_t p_row, void *) {
+		const real_t *above = heights.ptr() + (p_row * grid_width) + 1;
+		const real_t *row = above + grid_width;
+		const real_t *below = row + grid_width;
+		for (int x = 0; x < width; ++x) {
+			const int pixel = (p_row * width) + x;
+			const real_t center = row[x] * height_scale;
+			if (height_map) {
+				height_map[pixel] = center;
+			}
+			// Rise per unit of distance along the columns and the rows of the image.
+			const real_t dx = ((row[x + 1] - row[x - 1]) * height_scale) / (2. * step.x);
+			const real_t dy = ((below[x] - above[x]) * height_scale) / (2. * step.y);
+			if (normal_map) {
+				const Vector3 normal = Vector3(-dx, dy, 1.).normalized();
+				uint8_t *rgb = normal_map + (pixel * 3);
+				rgb[0] = uint8_t(CLAMP(Math::round(((normal.x * 0.5) + 0.5) * 255.), 0., 255.));
+				rgb[1] = uint8_t(CLAMP(Math::round(((normal.y * 0.5) + 0.5) * 255.), 0., 255.));
+				rgb[2] = uint8_t(CLAMP(Math::round(((normal.z * 0.5) + 0.5) * 255.), 0., 255.));
+			}
+			if (slope_map) {
+				slope_map[pixel] = Math::atan(Math::sqrt((dx * dx) + (dy * dy)));
+			}
+			if (curvature_map) {
+				const real_t along_x = ((row[x + 1] * height_scale) - (2. * center) + (row[x - 1] * height_scale)) / (step.x * step.x);
+				const real_t along_y = ((below[x] * height_scale) - (2. * center) + (above[x] * height_scale)) / (step.y * step.y);
+				curvature_map[pixel] = along_x + along_y;
+			}
+		}
+	}
+};
+
+Dictionary NoiseNode::get_terrain_maps(const Rect2 &p_region, int p_width, int p_height, real_t p_height_scale, int p_maps) const {
+	ERR_FAIL_COND_V(p_width <= 0 || p_height <= 0, Dictionary());
+	ERR_FAIL_COND_V(p_region.size.x <= 0. || p_region.size.y <= 0., Dictionary());
+
+	NoiseNodeTerrainPass pass;
+	pass.source = this;
+	pass.origin = p_region.position;
+	pass.step = Vector2(p_region.size.x / p_width, p_region.size.y / p_height);
+	pass.width = p_width;
+	pass.height = p_height;
+	pass.height_scale = p_height_scale;
+
+	const int pixel_count = p_width * p_height;
+	Vector<uint8_t> height_data, normal_data, slope_data, curvature_data;
+	// Buffers are resized before the pass, so that the workers write through stable pointers.
+	if (p_maps & TERRAIN_MAP_HEIGHT) {
+		height_data.resize(pixel_count * sizeof(float));
+		pass.height_map = reinterpret_cast<float *>(height_data.ptrw());
+	}
+	if (p_maps & TERRAIN_MAP_NORMAL) {
+		normal_data.resize(pixel_count * 3);
+		pass.normal_map = normal_data.ptrw();
+	}
+	if (p_maps & TERRAIN_MAP_SLOPE) {
+		slope_data.resize(pixel_count * sizeof(float));
+		pass.slope_map = reinterpret_cast<float *>(slope_data.ptrw());
+	}
+	if (p_maps & TERRAIN_MAP_CURVATURE) {
+		curvature_data.resize(pixel_count * sizeof(float));
+		pass.curvature_map = reinterpret_cast<float *>(curvature_data.ptrw());
+	}
+	pass.run();
+
+	Dictionary maps;
+	if (p_maps & TERRAIN_MAP_HEIGHT) {
+		maps["height"] = Image::create_from_data(p_width, p_height, false, Image::FORMAT_RF, height_data);
+	}
+	if (p_maps & TERRAIN_MAP_NORMAL) {
+		maps["normal"] = Image::create_from_data(p_width, p_height, false, Image::FORMAT_RGB8, normal_data);
+	}
+	if (p_maps & TERRAIN_MAP_SLOPE) {
+		maps["slope"] = Image::create_from_data(p_width, p_height, false, Image::FORMAT_RF, slope_data);
+	}
+	if (p_maps & TERRAIN_MAP_CURVATURE) {
+		maps["curvature"] = Image::create_from_data(p_width, p_height, false, Image::FORMAT_RF, curvature_data);
+	}
+	return maps;
+}
+
+static uint64_t _hash_structure(const Object *p_object, HashMap<const Object *, uint64_t> &r_known);
+
+static uint64_t _hash_value(const Variant &p_value, HashMap<const Object *, uint64_t> &r_known) {
+	switch (p_value.get_type()) {
+		case Variant::OBJECT:
+			return _hash_structure(p_value.get_validated_object(), r_known);
+		case Variant::ARRAY: {
+			// Elements are hashed by content, arrays of resources would otherwise hash their addresses.
+			const Array array = p_value;
+			uint32_t hash = hash_murmur3_one_32(array.size());
+			for (int i = 0; i < array.size(); ++i) {
+				hash = hash_murmur3_one_64(_hash_value(array[i], r_known), hash);
+			}
+			return hash_fmix32(hash);
+		}
+		default:
+			return p_value.recursive_hash(0);
+	}
+}
+
+static uint64_t _hash_structure(const Object *p_object, HashMap<const Object *, uint64_t> &r_known) {
+	if (!p_object) {
+		return 0;
+	}
+	const uint64_t *known = r_known.getptr(p_object);
+	if (known) {
+		return *known;
+	}
+	// Placeholder, in case the graph loops back to this object.
+	r_known.insert(p_object, 0);
+
+	// Two independent 32 bits chains, keeping collisions between distinct graphs out of reach.
+	uint32_t low = hash_murmur3_one_32(p_object->get_class().hash());
+	uint32_t high = hash_murmur3_one_32(low, 0x9E3779B9);
+	List<PropertyInfo> properties;
+	p_object->get_property_list(&properties);
+	for (const PropertyInfo &property : properties) {
+		// Names and paths of the resources have no effect on the values.
+		if (!(property.usage & PROPERTY_USAGE_STORAGE) || String(property.name).begins_with("resource_")) {
+			continue;
+		}
+		const uint32_t name = String(property.name).hash();
+		const uint64_t value = _hash_value(p_object->get(property.name), r_known);
+		low = hash_murmur3_one_64(value, hash_murmur3_one_32(name, low));
+		high = hash_murmur3_one_64(value ^ 0xA5A5A5A5A5A5A5A5, hash_murmur3_one_32(name, high));
+	}
+	const uint64_t hash = (uint64_t(hash_fmix32(high)) << 32) | hash_fmix32(low);
+	r_known.insert(p_object, hash);
+	return hash;
+}
+
+uint64_t NoiseNode::get_structure_hash(const Ref<Noise> &p_noise) {
+	HashMap<const Object *, uint64_t> known;
+	return _hash_structure(p_noise.ptr(), known);
+}
+
+Ref<Noise> NoiseNode::compile() {
+	Ref<CompiledNoise> compiled;
+	compiled.instantiate();
+	compiled->set_source(Ref<Noise>(this));
+	return compiled;
+}
+
+PackedFloat32Array NoiseNode::_get_noise_1d_batch(const PackedFloat32Array &p_x) const {
+	LocalVector<real_t> coords;
+	LocalVector<real_t> values;
+	coords.resize(p_x.size());
+	values.resize(p_x.size());
+	for (int i = 0; i < p_x.size(); ++i) {
+		coords[i] = p_x[i];
+	}
+	get_noise_1d_batch(coords.ptr(), values.ptr(), p_x.size());
+
+	PackedFloat32Array result;
+	result.resize(p_x.size());
+	float *w = result.ptrw();
+	for (int i = 0; i < p_x.size(); ++i) {
+		w[i] = values[i];
+	}
+	return result;
+}
+
+PackedFloat32Array NoiseNode::_get_noise_2d_batch(const PackedVector2Array &p_v) const {
+	LocalVector<real_t> values;
+	values.resize(p_v.size());
+	get_noise_2d_batch(p_v.ptr(), values.ptr(), p_v.size());
+
+	PackedFloat32Array result;
+	result.resize(p_v.size());
+	float *w = result.ptrw();
+	for (int i = 0; i < p_v.size(); ++i) {
+		w[i] = values[i];
+	}
+	return result;
+}
+
+PackedFloat32Array NoiseNode::_get_noise_3d_batch(const PackedVector3Array &p_v) const {
+	LocalVector<real_t> values;
+	values.resize(p_v.size());
+	get_noise_3d_batch(p_v.ptr(), values.ptr(), p_v.size());
+
+	PackedFloat32Array result;
+	result.resize(p_v.size());
+	float *w = result.ptrw();
+	for (int i = 0; i < p_v.size(); ++i) {
+		w[i] = values[i];
+	}
+	return result;
+}
+
+// Changes delayed by the batch running on the current thread.
+struct NoiseNodeChangeBatch {
+	int depth{ 0 };
+	LocalVector<Ref<NoiseNode>> pending;
+};
+
+static thread_local NoiseNodeChangeBatch change_batch;
+
+// Length of the longest path to a leaf, so that operands are always notified before their users.
+static int _get_node_height(const Ref<Noise> &p_noise, HashMap<const Noise *, int> &r_heights) {
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	if (!node) {
+		return 0;
+	}
+	const int *known = r_heights.getptr(node);
+	if (known) {
+		return *known;
+	}
+	int height = 0;
+	for (int i = 0; i < node->get_child_count(); ++i) {
+		height = MAX(height, _get_node_height(node->get_child(i), r_heights) + 1);
+	}
+	r_heights.insert(node, height);
+	return height;
+}
+
+void NoiseNode::begin_batch() {
+	++change_batch.depth;
+}
+
+void NoiseNode::end_batch() {
+	ERR_FAIL_COND_MSG(change_batch.depth <= 0, "No batch of changes to end.");
+	if (change_batch.depth > 1) {
+		--change_batch.depth;
+		return;
+	}
+	// Notifications of the flushed nodes pend their users, flushed in turn once all of their operands are.
+	HashMap<const Noise *, int> heights;
+	while (!change_batch.pending.is_empty()) {
+		uint32_t next = 0;
+		int lowest = _get_node_height(change_batch.pending[0], heights);
+		for (uint32_t i = 1; i < change_batch.pending.size(); ++i) {
+			const int height = _get_node_height(change_batch.pending[i], heights);
+			if (height < lowest) {
+				next = i;
+				lowest = height;
+			}
+		}
+		Ref<NoiseNode> node = change_batch.pending[next];
+		change_batch.pending.remove_at_unordered(next);
+		node->change_pending = false;
+		node->_flush_changed();
+	}
+	change_batch.depth = 0;
+}
+
+void NoiseNode::_notify_changed() {
+	if (change_batch.depth == 0) {
+		_flush_changed();
+		return;
+	}
+	if (!change_pending) {
+		change_pending = true;
+		change_batch.pending.push_back(Ref<NoiseNode>(this));
+	}
+}
+
+void NoiseNode::get_noise_2d_region_batch(const Rect2 &p_region, const Vector2 *p_v, real_t *r_values, int p_count) const {
+	NoiseProgram program;
+	program.build(Ref<Noise>(const_cast<NoiseNode *>(this)), false, NoiseRegion::rect(p_region));
+	program.run_batch(p_v, r_values, p_count);
+}
+
+void NoiseNode::get_noise_3d_region_batch(const AABB &p_region, const Vector3 *p_v, real_t *r_values, int p_count) const {
+	NoiseProgram program;
+	program.build(Ref<Noise>(const_cast<NoiseNode *>(this)), false, NoiseRegion::volume(p_region));
+	program.run_batch(p_v, r_values, p_count);
+}
+
+PackedFloat32Array NoiseNode::_get_noise_2d_region_batch(const Rect2 &p_region, const PackedVector2Array &p_v) const {
+	LocalVector<real_t> values;
+	values.resize(p_v.size());
+	get_noise_2d_region_batch(p_region, p_v.ptr(), values.ptr(), p_v.size());
+
+	PackedFloat32Array result;
+	result.resize(p_v.size());
+	float *w = result.ptrw();
+	for (int i = 0; i < p_v.size(); ++i) {
+		w[i] = values[i];
+	}
+	return result;
+}
+
+PackedFloat32Array NoiseNode::_get_noise_3d_region_batch(const AABB &p_region, const PackedVector3Array &p_v) const {
+	LocalVector<real_t> values;
+	values.resize(p_v.size());
+	get_noise_3d_region_batch(p_region, p_v.ptr(), values.ptr(), p_v.size());
+
+	PackedFloat32Array result;
+	result.resize(p_v.size());
+	float *w = result.ptrw();
+	for (int i = 0; i < p_v.size(); ++i) {
+		w[i] = values[i];
+	}
+	return result;
+}
+
+static real_t _get_central_gradient(const Noise *p_noise, const Vector2 &p_v, Vector2 &r_gradient) {
+	static constexpr real_t STEP = NoiseNode::GRADIENT_STEP;
+	r_gradient.x = p_noise->get_noise_2d(p_v.x + STEP, p_v.y) - p_noise->get_noise_2d(p_v.x - STEP, p_v.y);
+	r_gradient.y = p_noise->get_noise_2d(p_v.x, p_v.y + STEP) - p_noise->get_noise_2d(p_v.x, p_v.y - STEP);
+	r_gradient /= 2. * STEP;
+	return p_noise->get_noise_2d(p_v.x, p_v.y);
+}
+
+static real_t _get_central_gradient(const Noise *p_noise, const Vector3 &p_v, Vector3 &r_gradient) {
+	static constexpr real_t STEP = NoiseNode::GRADIENT_STEP;
+	r_gradient.x = p_noise->get_noise_3d(p_v.x + STEP, p_v.y, p_v.z) - p_noise->get_noise_3d(p_v.x - STEP, p_v.y, p_v.z);
+	r_gradient.y = p_noise->get_noise_3d(p_v.x, p_v.y + STEP, p_v.z) - p_noise->get_noise_3d(p_v.x, p_v.y - STEP, p_v.z);
+	r_gradient.z = p_noise->get_noise_3d(p_v.x, p_v.y, p_v.z + STEP) - p_noise->get_noise_3d(p_v.x, p_v.y, p_v.z - STEP);
+	r_gradient /= 2. * STEP;
+	return p_noise->get_noise_3d(p_v.x, p_v.y, p_v.z);
+}
+
+real_t NoiseNode::get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const {
+	return _get_central_gradient(this, p_v, r_gradient);
+}
+
+real_t NoiseNode::get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const {
+	return _get_central_gradient(this, p_v, r_gradient);
+}
+
+real_t NoiseNode::get_gradient(const Ref<Noise> &p_noise, const Vector2 &p_v, Vector2 &r_gradient) {
+	if (p_noise.is_null()) {
+		r_gradient = Vector2();
+		return 0.;
+	}
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	return node ? node->get_noise_2d_gradient(p_v, r_gradient) : _get_central_gradient(p_noise.ptr(), p_v, r_gradient);
+}
+
+real_t NoiseNode::get_gradient(const Ref<Noise> &p_noise, const Vector3 &p_v, Vector3 &r_gradient) {
+	if (p_noise.is_null()) {
+		r_gradient = Vector3();
+		return 0.;
+	}
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	return node ? node->get_noise_3d_gradient(p_v, r_gradient) : _get_central_gradient(p_noise.ptr(), p_v, r_gradient);
+}
+
+Vector3 NoiseNode::get_noise_2d_with_gradient(const Vector2 &p_v) const {
+	Vector2 gradient;
+	const real_t value = get_noise_2d_gradient(p_v, gradient);
+	return Vector3(value, gradient.x, gradient.y);
+}
+
+Vector4 NoiseNode::get_noise_3d_with_gradient(const Vector3 &p_v) const {
+	Vector3 gradient;
+	const real_t value = get_noise_3d_gradient(p_v, gradient);
+	return Vector4(value, gradient.x, gradient.y, gradient.z);
+}
+
+NoiseNode::~NoiseNode() {
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+	NoiseProfiler::forget(this);
+#endif
+}
+
+void NoiseNode::set_profiling_enabled(bool p_enabled) {
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+	NoiseProfiler::set_enabled(p_enabled);
+#else
+	ERR_FAIL_COND_MSG(p_enabled, "Noise profiling is not available, the module was built without noise_composer_profiling.");
+#endif
+}
+
+bool NoiseNode::is_profiling_enabled() {
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+	return NoiseProfiler::is_enabled();
+#else
+	return false;
+#endif
+}
+
+void NoiseNode::reset_profile() {
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+	NoiseProfiler::reset();
+#endif
+}
+
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+static void _store_counters(const NoiseProfiler::Counters &p_counters, Dictionary &r_profile) {
+	r_profile["calls"] = p_counters.calls;
+	r_profile["samples"] = p_counters.samples;
+	r_profile["inclusive_usec"] = p_counters.inclusive_nsec / 1000.;
+	r_profile["exclusive_usec"] = p_counters.exclusive_nsec / 1000.;
+	r_profile["cache_hits"] = p_counters.cache_hits;
+	r_profile["cache_misses"] = p_counters.cache_misses;
+}
+#endif
+
+static Dictionary _get_profile(const Ref<Noise> &p_noise, HashSet<const Noise *> &r_visited) {
+	Dictionary profile;
+	profile["class"] = p_noise->get_class();
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	if (!node) {
+		return profile;
+	}
+	if (r_visited.has(node)) {
+		profile["shared"] = true;
+		return profile;
+	}
+	r_visited.insert(node);
+
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+	HashMap<uint64_t, NoiseProfiler::Counters> threads;
+	NoiseProfiler::get_counters(node, threads);
+	NoiseProfiler::Counters total;
+	Array per_thread;
+	for (const KeyValue<uint64_t, NoiseProfiler::Counters> &E : threads) {
+		total.add(E.value);
+		Dictionary thread;
+		thread["thread"] = E.key;
+		_store_counters(E.value, thread);
+		per_thread.push_back(thread);
+	}
+	_store_counters(total, profile);
+	profile["threads"] = per_thread;
+#endif
+
+	Array children;
+	for (int i = 0; i < node->get_child_count(); ++i) {
+		const Ref<Noise> child = node->get_child(i);
+		if (child.is_valid()) {
+			children.push_back(_get_profile(child, r_visited));
+		}
+	}
+	profile["children"] = children;
+	return profile;
+}
+
+Dictionary NoiseNode::get_profile() const {
+	HashSet<const Noise *> visited;
+	return _get_profile(Ref<Noise>(const_cast<NoiseNode *>(this)), visited);
+}
+
+void NoiseNode::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_child", "n"), &NoiseNode::get_child);
+	ClassDB::bind_method(D_METHOD("get_child_count"), &NoiseNode::get_child_count);
+
+	ClassDB::bind_method(D_METHOD("compile"), &NoiseNode::compile);
+	ClassDB::bind_method(D_METHOD("get_structure_hash"), &NoiseNode::_get_structure_hash);
+	ClassDB::bind_static_method("NoiseNode", D_METHOD("begin_batch"), &NoiseNode::begin_batch);
+	ClassDB::bind_static_method("NoiseNode", D_METHOD("end_batch"), &NoiseNode::end_batch);
+	ClassDB::bind_static_method("NoiseNode", D_METHOD("set_profiling_enabled", "enabled"), &NoiseNode::set_profiling_enabled);
+	ClassDB::bind_static_method("NoiseNode", D_METHOD("is_profiling_enabled"), &NoiseNode::is_profiling_enabled);
+	ClassDB::bind_static_method("NoiseNode", D_METHOD("reset_profile"), &NoiseNode::reset_profile);
+	ClassDB::bind_method(D_METHOD("get_profile"), &NoiseNode::get_profile);
+	ClassDB::bind_method(D_METHOD("get_output_range"), &NoiseNode::get_output_range);
+	ClassDB::bind_method(D_METHOD("get_bounds_2d", "rect"), &NoiseNode::get_bounds_2d);
+	ClassDB::bind_method(D_METHOD("get_bounds_3d", "box"), &NoiseNode::get_bounds_3d);
+
+	ClassDB::bind_method(D_METHOD("get_noise_2d_with_gradient", "v"), &NoiseNode::get_noise_2d_with_gradient);
+	ClassDB::bind_method(D_METHOD("get_noise_3d_with_gradient", "v"), &NoiseNode::get_noise_3d_with_gradient);
+
+	ClassDB::bind_method(D_METHOD("get_terrain_maps", "region", "width", "height", "height_scale", "maps"), &NoiseNode::get_terrain_maps, DEFVAL(1.), DEFVAL(TERRAIN_MAP_HEIGHT | TERRAIN_MAP_NORMAL));
+
+	ClassDB::bind_method(D_METHOD("get_noise_1d_batch", "x"), &NoiseNode::_get_noise_1d_batch);
+	ClassDB::bind_method(D_METHOD("get_noise_2d_batch", "v"), &NoiseNode::_get_noise_2d_batch);
+	ClassDB::bind_method(D_METHOD("get_noise_3d_batch", "v"), &NoiseNode::_get_noise_3d_batch);
+	ClassDB::bind_method(D_METHOD("get_noise_2d_region_batch", "region", "v"), &NoiseNode::_get_noise_2d_region_batch);
+	ClassDB::bind_method(D_METHOD("get_noise_3d_region_batch", "region", "v"), &NoiseNode::_get_noise_3d_region_batch);
+
+	BIND_ENUM_CONSTANT(TERRAIN_MAP_HEIGHT);
+	BIND_ENUM_CONSTANT(TERRAIN_MAP_NORMAL);
+	BIND_ENUM_CONSTANT(TERRAIN_MAP_SLOPE);
+	BIND_ENUM_CONSTANT(TERRAIN_MAP_CURVATURE);
+}
@@ -1,29 +1,160 @@
 #ifndef NOISE_COMPOSER_BASE_H
 #define NOISE_COMPOSER_BASE_H
 
+#include "core/math/vector4.h"
+#include "core/templates/local_vector.h"
 #include "modules/noise/noise.h"
+#include "noise_interval.h"
+#include "noise_profiler.h"
+#include <algorithm>
 #include <cstddef>
 #include <iterator>
 
+class NoiseProgram;
+
 class NoiseNode : public Noise {
 	GDCLASS(NoiseNode, Noise);
 
 public:
+	// Maximum number of samples an operator evaluates at once when working on buffers.
+	static constexpr int BATCH_SIZE = 256;
+
 	NoiseNode(size_t c) :
 			count{ c } {}
+	virtual ~NoiseNode();
 
-	int get_child_count() { return count; }
+	int get_child_count() const { return count; }
 
 	virtual Ref<Noise> get_child(int n) const = 0;
 
+	// Batch evaluation. Default implementations sample point by point.
+	virtual void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const;
+	virtual void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const;
+	virtual void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const;
+
+	// Batch evaluation of any noise, using the batch entry points when it is a NoiseNode.
+	static void sample_batch(const Ref<Noise> &p_noise, const real_t *p_x, real_t *r_values, int p_count);
+	static void sample_batch(const Ref<Noise> &p_noise, const Vector2 *p_v, real_t *r_values, int p_count);
+	static void sample_batch(const Ref<Noise> &p_noise, const Vector3 *p_v, real_t *r_values, int p_count);
+
+	// Value and gradient at a point. Nodes propagate the gradients of their operands by the chain rule, the
+	// default and noises other than nodes use central differences of GRADIENT_STEP, as operators do for their
+	// partial derivatives when they lack exact ones.
+	static constexpr real_t GRADIENT_STEP = 1e-2;
+	virtual real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const;
+	virtual real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const;
+	static real_t get_gradient(const Ref<Noise> &p_noise, const Vector2 &p_v, Vector2 &r_gradient);
+	static real_t get_gradient(const Ref<Noise> &p_noise, const Vector3 &p_v, Vector3 &r_gradient);
+
+	// Value followed by the gradient.
+	Vector3 get_noise_2d_with_gradient(const Vector2 &p_v) const;
+	Vector4 get_noise_3d_with_gradient(const Vector3 &p_v) const;
+
+	// Metadata declaring the range of a noise, as a Vector2. Overrides the bounds assumed for other noises.
+	static constexpr const char *RANGE_META = "noise_range";
+	// Metadata declaring the largest change of a noise per unit of distance, used to bound it over regions.
+	static constexpr const char *LIPSCHITZ_META = "noise_lipschitz";
+
+	// Results of prune().
+	enum {
+		PRUNE_NONE = -1,
+		PRUNE_CONSTANT = -2,
+	};
+
+	// Conservative bounds of the values of this node over a region, derived from its operands. Strict
+	// bounds only rely on declared properties and exact rules, so that no value at all can fall outside.
+	virtual NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const { return NoiseInterval(); }
+	NoiseInterval get_output_interval(bool p_strict = false) const { return get_region_interval(NoiseRegion(), p_strict); }
+	Vector2 get_output_range() const { return get_output_interval().to_vector2(); }
+	Vector2 get_bounds_2d(const Rect2 &p_rect) const { return get_region_interval(NoiseRegion::rect(p_rect)).to_vector2(); }
+	Vector2 get_bounds_3d(const AABB &p_box) const { return get_region_interval(NoiseRegion::volume(p_box)).to_vector2(); }
+
+	// Whether the node can be skipped over the whole region: returns the index of the child giving its
+	// value everywhere in the region, PRUNE_CONSTANT with the value set, or PRUNE_NONE.
+	virtual int prune(const NoiseRegion &p_region, real_t &r_value) const { return PRUNE_NONE; }
+
+	// Bounds of any noise. Noises other than nodes are assumed within [-1, 1] unless they declare a range,
+	// or unbounded when strict.
+	static NoiseInterval get_interval(const Ref<Noise> &p_noise, bool p_strict = false);
+	static NoiseInterval get_interval(const Ref<Noise> &p_noise, const NoiseRegion &p_region, bool p_strict = false);
+
+	// Batch evaluation of points all within the region, skipping the parts of the graph the region prunes.
+	void get_noise_2d_region_batch(const Rect2 &p_region, const Vector2 *p_v, real_t *r_values, int p_count) const;
+	void get_noise_3d_region_batch(const AABB &p_region, const Vector3 *p_v, real_t *r_values, int p_count) const;
+
+	// Appends the instructions computing this node to the program and returns the register holding its
+	// value, or -1 when the node has to be called as a leaf.
+	virtual int emit_instructions(NoiseProgram &p_program) const { return -1; }
+
+	// Image generation, sampling the graph over tiles spread on the worker thread pool.
+	virtual Ref<Image> get_image(int p_width, int p_height, bool p_invert = false, bool p_in_3d_space = false, bool p_normalize = true) const override;
+	virtual Ref<Image> get_seamless_image(int p_width, int p_height, bool p_invert = false, bool p_in_3d_space = false, real_t p_blend_skirt = 0.1, bool p_normalize = true) const override;
+
+	// Maps get_terrain_maps() can fill.
+	enum TerrainMap {
+		// Heights, FORMAT_RF.
+		TERRAIN_MAP_HEIGHT = 1,
+		// Normals, encoded as a FORMAT_RGB8 normal map with green pointing up the image.
+		TERRAIN_MAP_NORMAL = 2,
+		// Angle of the surface with the horizontal, in radians, FORMAT_RF.
+		TERRAIN_MAP_SLOPE = 4,
+		// Laplacian of the heights, positive in hollows, FORMAT_RF.
+		TERRAIN_MAP_CURVATURE = 8,
+	};
+
+	// Terrain maps of a tile of pixels laid over the region, keyed "height", "normal", "slope" and "curvature".
+	// Heights are the values scaled by the height scale. The graph is sampled once per pixel, plus an apron
+	// of one pixel around the tile, the other maps being derived from the neighbouring heights.
+	Dictionary get_terrain_maps(const Rect2 &p_region, int p_width, int p_height, real_t p_height_scale = 1., int p_maps = TERRAIN_MAP_HEIGHT | TERRAIN_MAP_NORMAL) const;
+
+	// Wraps this graph into a CompiledNoise.
+	Ref<Noise> compile();
+
+	// Hash of everything the values of a noise depend on: the classes of the resources in its graph and
+	// their stored properties, seeds included. Stable across runs, meant to key persisted values.
+	static uint64_t get_structure_hash(const Ref<Noise> &p_noise);
+	int64_t _get_structure_hash() const { return get_structure_hash(Ref<Noise>(const_cast<NoiseNode *>(this))); }
+
+	// Changes notified by the nodes between these calls, on the calling thread, are delayed until the
+	// outermost end_batch(). Each changed node is then notified once, after all of its changed operands.
+	static void begin_batch();
+	static void end_batch();
+
+	// Batch of changes lasting as long as the guard.
+	struct BatchGuard {
+		BatchGuard() { begin_batch(); }
+		~BatchGuard() { end_batch(); }
+	};
+
+	// Profiling of the evaluations, recording per node and per thread the calls, the samples, the inclusive and
+	// exclusive times and the cache hits. Only available when built with the noise_composer_profiling option.
+	static void set_profiling_enabled(bool p_enabled);
+	static bool is_profiling_enabled();
+	static void reset_profile();
+	// Counters of this node and of the nodes below, as a tree of dictionaries mirroring the graph. A node reached
+	// again through another path is only marked as shared.
+	Dictionary get_profile() const;
+
+	PackedFloat32Array _get_noise_1d_batch(const PackedFloat32Array &p_x) const;
+	PackedFloat32Array _get_noise_2d_batch(const PackedVector2Array &p_v) const;
+	PackedFloat32Array _get_noise_3d_batch(const PackedVector3Array &p_v) const;
+	PackedFloat32Array _get_noise_2d_region_batch(const Rect2 &p_region, const PackedVector2Array &p_v) const;
+	PackedFloat32Array _get_noise_3d_region_batch(const AABB &p_region, const PackedVector3Array &p_v) const;
+
 protected:
-	static void _bind_methods() {
-		ClassDB::bind_method(D_METHOD("get_child", "n"), &NoiseNode::get_child);
-		ClassDB::bind_method(D_METHOD("get_child_count"), &NoiseNode::get_child_count);
-	}
+	static void _bind_methods();
+
+	// Notifies a change of this node, at once or at the end of the running batch.
+	void _notify_changed();
+	// Actual notification of the change.
+	virtual void _flush_changed() { emit_changed(); }
+
+	// For nodes whose number of children changes.
+	void _set_child_count(size_t p_count) { count = p_count; }
 
 private:
 	size_t count;
+	bool change_pending{ false };
 
 public:
 	struct Iterator {
@@ -62,4 +193,6 @@ public:
 	Iterator end() { return Iterator(this, count); }
 };
 
-#endif
\ No newline at end of file
+VARIANT_ENUM_CAST(NoiseNode::TerrainMap);
+
+#endif
@@ -0,0 +1,604 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_benchmark.h"
+
+#include "core/io/json.h"
+#include "core/math/random_pcg.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/os.h"
+#include "modules/noise/fastnoise_lite.h"
+#include "noise_baked.h"
+#include "noise_composer.h"
+#include "noise_program.h"
+#include "noise_tile_cache.h"
+#include <functional>
+
+// Points are spread over a square of this half extent, around the origin.
+static constexpr real_t POINT_EXTENT = 1024.;
+
+static const char *NODE_CLASSES[] = {
+	"FastNoiseLite",
+	"ConstantNoise",
+	"AddNoise",
+	"MultiplyNoise",
+	"MaxNoise",
+	"MinNoise",
+	"PowerNoise",
+	"AbsoluteNoise",
+	"InvertNoise",
+	"ClampNoise",
+	"CurveNoise",
+	"AffineNoise",
+	"MixNoise",
+	"SelectNoise",
+	"MultiAddNoise",
+	"MultiMultiplyNoise",
+	"MultiMaxNoise",
+	"MultiMinNoise",
+	"WeightedSumNoise",
+	"NoiseProxy",
+	"LinearTransformNoise",
+	"RescalerNoise",
+	"CompiledNoise",
+	"BakedNoise",
+	"NoiseTileCache",
+};
+
+static const char *COLUMNS[] = {
+	"suite",
+	"node",
+	"dimension",
+	"depth",
+	"width",
+	"proxy",
+	"mode",
+	"threads",
+	"samples",
+	"ns_per_sample",
+	"samples_per_sec",
+	"range",
+	"step",
+	"recompute_ms",
+};
+
+// Combiner calling its function through a std::function on every sample, as the operators did before they got
+// compile-time kernels. Only measured by the "reference" suite, next to the actual operators.
+class FunctionCombinerNoise : public NoiseNode {
+public:
+	typedef std::function<real_t(const std::array<real_t, 2> &)> Function;
+
+	FunctionCombinerNoise(const Function &p_function, const Ref<Noise> &p_first, const Ref<Noise> &p_second) :
+			NoiseNode(2), function(p_function), operands{ { p_first, p_second } } {}
+
+	virtual Ref<Noise> get_child(int n) const override { return operands[n]; }
+
+	virtual real_t get_noise_1d(real_t p_x) const override {
+		std::array<real_t, 2> result;
+		for (size_t i = 0; i < 2; ++i) {
+			result[i] = operands[i].is_valid() ? operands[i]->get_noise_1d(p_x) : 0.;
+		}
+		return function(result);
+	}
+
+	virtual real_t get_noise_2dv(Vector2 p_v) const override { return get_noise_2d(p_v.x, p_v.y); }
+	virtual real_t get_noise_2d(real_t p_x, real_t p_y) const override {
+		std::array<real_t, 2> result;
+		for (size_t i = 0; i < 2; ++i) {
+			result[i] = operands[i].is_valid() ? operands[i]->get_noise_2d(p_x, p_y) : 0.;
+		}
+		return function(result);
+	}
+
+	virtual real_t get_noise_3dv(Vector3 p_v) const override { return get_noise_3d(p_v.x, p_v.y, p_v.z); }
+	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override {
+		std::array<real_t, 2> result;
+		for (size_t i = 0; i < 2; ++i) {
+			result[i] = operands[i].is_valid() ? operands[i]->get_noise_3d(p_x, p_y, p_z) : 0.;
+		}
+		return function(result);
+	}
+
+private:
+	Function function;
+	std::array<Ref<Noise>, 2> operands;
+};
+
+template <typename T>
+static Ref<T> _make_unary(const Ref<Noise> *p_operands) {
+	Ref<T> node;
+	node.instantiate();
+	node->set_source(p_operands[0]);
+	return node;
+}
+
+template <typename T>
+static Ref<T> _make_binary(const Ref<Noise> *p_operands) {
+	Ref<T> node;
+	node.instantiate();
+	node->set_first_noise(p_operands[0]);
+	node->set_second_noise(p_operands[1]);
+	return node;
+}
+
+template <typename T>
+static Ref<T> _make_ternary(const Ref<Noise> *p_operands) {
+	Ref<T> node = _make_binary<T>(p_operands);
+	node->set_selector_noise(p_operands[2]);
+	return node;
+}
+
+template <typename T>
+static Ref<T> _make_array(const Ref<Noise> *p_operands) {
+	TypedArray<Noise> noises;
+	for (int i = 0; i < 3; ++i) {
+		noises.push_back(p_operands[i]);
+	}
+	Ref<T> node;
+	node.instantiate();
+	node->set_noises(noises);
+	return node;
+}
+
+void NoiseBenchmark::set_sample_count(int p_count) {
+	ERR_FAIL_COND(p_count <= 0);
+	sample_count = p_count;
+}
+
+void NoiseBenchmark::set_repeat_count(int p_count) {
+	ERR_FAIL_COND(p_count <= 0);
+	repeat_count = p_count;
+}
+
+void NoiseBenchmark::set_max_depth(int p_depth) {
+	ERR_FAIL_COND(p_depth <= 0);
+	max_depth = p_depth;
+}
+
+void NoiseBenchmark::set_max_width(int p_width) {
+	ERR_FAIL_COND(p_width < 2);
+	max_width = p_width;
+}
+
+void NoiseBenchmark::set_thread_count(int p_count) {
+	ERR_FAIL_COND(p_count < 0);
+	thread_count = p_count;
+}
+
+Array NoiseBenchmark::run_suites() {
+	Array rows;
+	_generate_points();
+	leaf_seed = 0;
+	_run_operators(rows);
+	_run_references(rows);
+	_run_graphs(rows);
+	_run_rescaler(rows);
+	return rows;
+}
+
+String NoiseBenchmark::run(Format p_format) {
+	return format_rows(run_suites(), p_format);
+}
+
+PackedStringArray NoiseBenchmark::get_columns() {
+	PackedStringArray columns;
+	for (const char *column : COLUMNS) {
+		columns.push_back(column);
+	}
+	return columns;
+}
+
+String NoiseBenchmark::format_rows(const Array &p_rows, Format p_format) {
+	if (p_format == FORMAT_JSON) {
+		return JSON::stringify(p_rows, "\t");
+	}
+	const PackedStringArray columns = get_columns();
+	String csv = String(",").join(columns) + "\n";
+	for (int i = 0; i < p_rows.size(); ++i) {
+		const Dictionary row = p_rows[i];
+		PackedStringArray cells;
+		for (const String &column : columns) {
+			cells.push_back(row.has(column) ? String(row[column]) : String());
+		}
+		csv += String(",").join(cells) + "\n";
+	}
+	return csv;
+}
+
+void NoiseBenchmark::_generate_points() {
+	// Same points on every run, so that runs can be compared.
+	RandomPCG random;
+	points_1d.resize(sample_count);
+	points_2d.resize(sample_count);
+	points_3d.resize(sample_count);
+	for (int i = 0; i < sample_count; ++i) {
+		points_1d[i] = random.random(-POINT_EXTENT, POINT_EXTENT);
+		points_2d[i] = Vector2(random.random(-POINT_EXTENT, POINT_EXTENT), random.random(-POINT_EXTENT, POINT_EXTENT));
+		points_3d[i] = Vector3(random.random(-POINT_EXTENT, POINT_EXTENT), random.random(-POINT_EXTENT, POINT_EXTENT), random.random(-POINT_EXTENT, POINT_EXTENT));
+	}
+}
+
+void NoiseBenchmark::_sample_chunk(uint32_t p_chunk, SamplePass *p_pass) {
+	const int begin = p_chunk * CHUNK_SIZE;
+	const int count = MIN(CHUNK_SIZE, sample_count - begin);
+	const Ref<Noise> &noise = p_pass->noise;
+	real_t *values = p_pass->values + begin;
+	switch (p_pass->dimension) {
+		case 1:
+			if (p_pass->batch) {
+				NoiseNode::sample_batch(noise, points_1d.ptr() + begin, values, count);
+			} else {
+				for (int i = 0; i < count; ++i) {
+					values[i] = noise->get_noise_1d(points_1d[begin + i]);
+				}
+			}
+			break;
+		case 2:
+			if (p_pass->batch) {
+				NoiseNode::sample_batch(noise, points_2d.ptr() + begin, values, count);
+			} else {
+				for (int i = 0; i < count; ++i) {
+					values[i] = noise->get_noise_2dv(points_2d[begin + i]);
+				}
+			}
+			break;
+		default:
+			if (p_pass->batch) {
+				NoiseNode::sample_batch(noise, points_3d.ptr() + begin, values, count);
+			} else {
+				for (int i = 0; i < count; ++i) {
+					values[i] = noise->get_noise_3dv(points_3d[begin + i]);
+				}
+			}
+			break;
+	}
+}
+
+double NoiseBenchmark::_measure(const Ref<Noise> &p_noise, int p_dimension, bool p_batch, int p_threads) {
+	LocalVector<real_t> values;
+	values.resize(sample_count);
+	SamplePass pass;
+	pass.noise = p_noise;
+	pass.dimension = p_dimension;
+	pass.batch = p_batch;
+	pass.values = values.ptr();
+	const int chunks = (sample_count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	uint64_t best = UINT64_MAX;
+	// The first run is not timed, it only warms the graph up.
+	for (int run = 0; run <= repeat_count; ++run) {
+		const uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		if (p_threads <= 1) {
+			for (int i = 0; i < chunks; ++i) {
+				_sample_chunk(i, &pass);
+			}
+		} else {
+			WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(
+					this, &NoiseBenchmark::_sample_chunk, &pass, chunks, p_threads, true, SNAME("NoiseBenchmark"));
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+		}
+		const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+		if (run > 0) {
+			best = MIN(best, elapsed);
+		}
+	}
+	return (double(best) * 1000.) / sample_count;
+}
+
+void NoiseBenchmark::_measure_sampling(Array &r_rows, const String &p_suite, const String &p_node, const Ref<Noise> &p_noise, int p_dimension, int p_depth, int p_width, bool p_proxy) {
+	const int pool_threads = _get_pool_threads();
+	const int thread_counts[2] = { 1, pool_threads };
+	for (int batch = 0; batch < 2; ++batch) {
+		for (int i = 0; i < (pool_threads > 1 ? 2 : 1); ++i) {
+			const double ns_per_sample = _measure(p_noise, p_dimension, batch != 0, thread_counts[i]);
+			Dictionary row;
+			row["suite"] = p_suite;
+			row["node"] = p_node;
+			row["dimension"] = p_dimension;
+			row["depth"] = p_depth;
+			row["width"] = p_width;
+			row["proxy"] = p_proxy;
+			row["mode"] = batch ? "batch" : "point";
+			row["threads"] = thread_counts[i];
+			row["samples"] = sample_count;
+			row["ns_per_sample"] = ns_per_sample;
+			row["samples_per_sec"] = ns_per_sample > 0. ? 1e9 / ns_per_sample : 0.;
+			r_rows.push_back(row);
+		}
+	}
+}
+
+Ref<Noise> NoiseBenchmark::_make_node(const String &p_class, int p_dimension, bool p_proxy) {
+	if (p_class == "FastNoiseLite") {
+		return _make_leaf(false);
+	}
+	if (p_class == "ConstantNoise") {
+		Ref<ConstantNoise> constant;
+		constant.instantiate();
+		constant->set_value(0.5);
+		return constant;
+	}
+
+	const Ref<Noise> operands[3] = { _make_leaf(p_proxy), _make_leaf(p_proxy), _make_leaf(p_proxy) };
+	if (p_class == "AddNoise") {
+		return _make_binary<AddNoise>(operands);
+	} else if (p_class == "MultiplyNoise") {
+		return _make_binary<MultiplyNoise>(operands);
+	} else if (p_class == "MaxNoise") {
+		return _make_binary<MaxNoise>(operands);
+	} else if (p_class == "MinNoise") {
+		return _make_binary<MinNoise>(operands);
+	} else if (p_class == "PowerNoise") {
+		return _make_binary<PowerNoise>(operands);
+	} else if (p_class == "AbsoluteNoise") {
+		return _make_unary<AbsoluteNoise>(operands);
+	} else if (p_class == "InvertNoise") {
+		return _make_unary<InvertNoise>(operands);
+	} else if (p_class == "ClampNoise") {
+		return _make_unary<ClampNoise>(operands);
+	} else if (p_class == "CurveNoise") {
+		Ref<BetterCurve> curve;
+		curve.instantiate();
+		curve->add_point(Vector2(0., 0.));
+		curve->add_point(Vector2(0.5, 1.));
+		curve->add_point(Vector2(1., 0.));
+		Ref<CurveNoise> node = _make_unary<CurveNoise>(operands);
+		node->set_curve(curve);
+		return node;
+	} else if (p_class == "AffineNoise") {
+		Ref<AffineNoise> node = _make_unary<AffineNoise>(operands);
+		node->set_scale(0.5);
+		node->set_bias(0.25);
+		return node;
+	} else if (p_class == "MixNoise") {
+		return _make_ternary<MixNoise>(operands);
+	} else if (p_class == "SelectNoise") {
+		return _make_ternary<SelectNoise>(operands);
+	} else if (p_class == "MultiAddNoise") {
+		return _make_array<MultiAddNoise>(operands);
+	} else if (p_class == "MultiMultiplyNoise") {
+		return _make_array<MultiMultiplyNoise>(operands);
+	} else if (p_class == "MultiMaxNoise") {
+		return _make_array<MultiMaxNoise>(operands);
+	} else if (p_class == "MultiMinNoise") {
+		return _make_array<MultiMinNoise>(operands);
+	} else if (p_class == "WeightedSumNoise") {
+		Ref<WeightedSumNoise> node = _make_array<WeightedSumNoise>(operands);
+		PackedFloat32Array weights;
+		weights.push_back(0.5);
+		weights.push_back(0.25);
+		weights.push_back(0.25);
+		node->set_weights(weights);
+		return node;
+	} else if (p_class == "NoiseProxy") {
+		Ref<NoiseProxy> node;
+		node.instantiate();
+		node->set_source(operands[0]);
+		return node;
+	} else if (p_class == "LinearTransformNoise") {
+		Ref<LinearTransformNoise> node;
+		node.instantiate();
+		node->set_scale(2.);
+		node->set_transform_2d(Transform2D(0.5, Vector2(3., 7.)));
+		node->set_transform_3d(Transform3D(Basis(Vector3(0., 1., 0.), 0.5), Vector3(3., 7., 11.)));
+		node->set_inner_noise(operands[0]);
+		return node;
+	} else if (p_class == "RescalerNoise") {
+		Ref<RescalerNoise> node;
+		node.instantiate();
+		{
+			NoiseNode::BatchGuard batch;
+			node->set_range(64.);
+			node->set_step(1.);
+			node->set_noise(operands[0]);
+		}
+		while (node->is_working()) {
+			OS::get_singleton()->delay_usec(100);
+		}
+		return node;
+	} else if (p_class == "CompiledNoise") {
+		Ref<CompiledNoise> node;
+		node.instantiate();
+		node->set_source(_make_tree(2, 2, p_proxy));
+		return node;
+	} else if (p_class == "BakedNoise") {
+		Ref<BakedNoise> node;
+		node.instantiate();
+		{
+			NoiseNode::BatchGuard batch;
+			node->set_dimension(BakedNoise::Dimension(BakedNoise::DIMENSION_1D + p_dimension - 1));
+			node->set_domain(AABB(Vector3(-POINT_EXTENT, -POINT_EXTENT, -POINT_EXTENT), Vector3(2., 2., 2.) * POINT_EXTENT));
+			node->set_source(operands[0]);
+		}
+		while (node->is_working()) {
+			OS::get_singleton()->delay_usec(100);
+		}
+		return node;
+	} else if (p_class == "NoiseTileCache") {
+		Ref<NoiseTileCache> node;
+		node.instantiate();
+		node->set_source(operands[0]);
+		return node;
+	}
+	ERR_FAIL_V_MSG(Ref<Noise>(), vformat("No benchmark for the class '%s'.", p_class));
+}
+
+void NoiseBenchmark::_run_operators(Array &r_rows) {
+	for (const char *name : NODE_CLASSES) {
+		const String node_class = name;
+		// Leaves have no operand to wrap.
+		const bool has_operands = node_class != "FastNoiseLite" && node_class != "ConstantNoise";
+		for (int dimension = 1; dimension <= 3; ++dimension) {
+			for (int proxy = 0; proxy < (has_operands ? 2 : 1); ++proxy) {
+				const Ref<Noise> noise = _make_node(node_class, dimension, proxy != 0);
+				_measure_sampling(r_rows, "operator", node_class, noise, dimension, 1, 1, proxy != 0);
+			}
+		}
+	}
+}
+
+void NoiseBenchmark::_run_references(Array &r_rows) {
+	struct Reference {
+		const char *node_class;
+		FunctionCombinerNoise::Function function;
+	};
+	const Reference references[] = {
+		{ "AddNoise", [](const std::array<real_t, 2> &a) { return a[0] + a[1]; } },
+		{ "MultiplyNoise", [](const std::array<real_t, 2> &a) { return a[0] * a[1]; } },
+		{ "MaxNoise", [](const std::array<real_t, 2> &a) { return std::max(a[0], a[1]); } },
+		{ "MinNoise", [](const std::array<real_t, 2> &a) { return std::min(a[0], a[1]); } },
+	};
+	for (const Reference &reference : references) {
+		const String node_class = reference.node_class;
+		for (int dimension = 1; dimension <= 3; ++dimension) {
+			_measure_sampling(r_rows, "reference", node_class, _make_node(node_class, dimension, false), dimension, 1, 1, false);
+			const Ref<Noise> function_noise = memnew(FunctionCombinerNoise(reference.function, _make_leaf(false), _make_leaf(false)));
+			_measure_sampling(r_rows, "reference", node_class + " (std::function)", function_noise, dimension, 1, 1, false);
+		}
+	}
+}
+
+void NoiseBenchmark::_run_graphs(Array &r_rows) {
+	for (int width = 2; width <= max_width; width *= 2) {
+		int leaves = 1;
+		for (int depth = 1; depth <= max_depth; ++depth) {
+			leaves *= width;
+			if (leaves > MAX_GRAPH_LEAVES) {
+				break;
+			}
+			for (int dimension = 1; dimension <= 3; ++dimension) {
+				for (int proxy = 0; proxy < 2; ++proxy) {
+					_measure_sampling(r_rows, "graph", "tree", _make_tree(depth, width, proxy != 0), dimension, depth, width, proxy != 0);
+				}
+			}
+		}
+	}
+}
+
+void NoiseBenchmark::_run_rescaler(Array &r_rows) {
+	const real_t ranges[3] = { 64., 256., 1024. };
+	const real_t steps[3] = { 1., 4., 16. };
+	for (real_t range : ranges) {
+		for (real_t step : steps) {
+			Ref<RescalerNoise> rescaler;
+			rescaler.instantiate();
+			{
+				NoiseNode::BatchGuard batch;
+				rescaler->set_range(range);
+				rescaler->set_step(step);
+			}
+			// Only the computation started by the source is timed.
+			const uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			rescaler->set_noise(_make_leaf(false));
+			while (rescaler->is_working()) {
+				OS::get_singleton()->delay_usec(50);
+			}
+			const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+
+			const int rows = MAX(1, (int)Math::ceil(range / step));
+			Dictionary row;
+			row["suite"] = "rescaler";
+			row["node"] = "RescalerNoise";
+			row["dimension"] = 2;
+			row["threads"] = _get_pool_threads();
+			row["samples"] = rows * rows;
+			row["ns_per_sample"] = (double(elapsed) * 1000.) / (rows * rows);
+			row["samples_per_sec"] = elapsed > 0 ? (rows * rows * 1e6) / double(elapsed) : 0.;
+			row["range"] = range;
+			row["step"] = step;
+			row["recompute_ms"] = double(elapsed) / 1000.;
+			r_rows.push_back(row);
+		}
+	}
+}
+
+Ref<Noise> NoiseBenchmark::_make_leaf(bool p_proxy) {
+	Ref<FastNoiseLite> leaf;
+	leaf.instantiate();
+	leaf->set_seed(leaf_seed++);
+	leaf->set_frequency(0.01);
+	if (!p_proxy) {
+		return leaf;
+	}
+	Ref<NoiseProxy> proxy;
+	proxy.instantiate();
+	proxy->set_source(leaf);
+	return proxy;
+}
+
+// Each node combines p_width subtrees one less deep, adding them on even levels and keeping their maximum on
+// odd ones.
+Ref<Noise> NoiseBenchmark::_make_tree(int p_depth, int p_width, bool p_proxy) {
+	if (p_depth == 0) {
+		return _make_leaf(p_proxy);
+	}
+	Ref<Noise> result = _make_tree(p_depth - 1, p_width, p_proxy);
+	for (int i = 1; i < p_width; ++i) {
+		Ref<NoiseCombinerOperator> combiner;
+		if (p_depth % 2) {
+			combiner = Ref<NoiseCombinerOperator>(memnew(MaxNoise));
+		} else {
+			combiner = Ref<NoiseCombinerOperator>(memnew(AddNoise));
+		}
+		combiner->set_first_noise(result);
+		combiner->set_second_noise(_make_tree(p_depth - 1, p_width, p_proxy));
+		result = combiner;
+	}
+	return result;
+}
+
+int NoiseBenchmark::_get_pool_threads() const {
+	return thread_count > 0 ? thread_count : WorkerThreadPool::get_singleton()->get_thread_count();
+}
+
+void NoiseBenchmark::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_sample_count", "count"), &NoiseBenchmark::set_sample_count);
+	ClassDB::bind_method(D_METHOD("get_sample_count"), &NoiseBenchmark::get_sample_count);
+
+	ClassDB::bind_method(D_METHOD("set_repeat_count", "count"), &NoiseBenchmark::set_repeat_count);
+	ClassDB::bind_method(D_METHOD("get_repeat_count"), &NoiseBenchmark::get_repeat_count);
+
+	ClassDB::bind_method(D_METHOD("set_max_depth", "depth"), &NoiseBenchmark::set_max_depth);
+	ClassDB::bind_method(D_METHOD("get_max_depth"), &NoiseBenchmark::get_max_depth);
+
+	ClassDB::bind_method(D_METHOD("set_max_width", "width"), &NoiseBenchmark::set_max_width);
+	ClassDB::bind_method(D_METHOD("get_max_width"), &NoiseBenchmark::get_max_width);
+
+	ClassDB::bind_method(D_METHOD("set_thread_count", "count"), &NoiseBenchmark::set_thread_count);
+	ClassDB::bind_method(D_METHOD("get_thread_count"), &NoiseBenchmark::get_thread_count);
+
+	ClassDB::bind_method(D_METHOD("run_suites"), &NoiseBenchmark::run_suites);
+	ClassDB::bind_method(D_METHOD("run", "format"), &NoiseBenchmark::run, DEFVAL(FORMAT_JSON));
+
+	ClassDB::bind_static_method("NoiseBenchmark", D_METHOD("get_columns"), &NoiseBenchmark::get_columns);
+	ClassDB::bind_static_method("NoiseBenchmark", D_METHOD("format_rows", "rows", "format"), &NoiseBenchmark::format_rows);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "sample_count", PROPERTY_HINT_RANGE, "1,16777216,1"), "set_sample_count", "get_sample_count");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "repeat_count", PROPERTY_HINT_RANGE, "1,100,1"), "set_repeat_count", "get_repeat_count");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_depth", PROPERTY_HINT_RANGE, "1,16,1"), "set_max_depth", "get_max_depth");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_width", PROPERTY_HINT_RANGE, "2,64,1"), "set_max_width", "get_max_width");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "thread_count", PROPERTY_HINT_RANGE, "0,256,1"), "set_thread_count", "get_thread_count");
+
+	BIND_ENUM_CONSTANT(FORMAT_JSON);
+	BIND_ENUM_CONSTANT(FORMAT_CSV);
+}
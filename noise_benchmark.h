@@ -0,0 +1,127 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_BENCHMARK_H
+#define NOISE_BENCHMARK_H
+
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+#include "noise_base.h"
+
+// Measures the sampling cost of the nodes of the module, one row per measure, exported as JSON or CSV so that
+// runs can be diffed. The module is only built within the engine, so the suite is run from a script:
+//   godot --headless --script bench.gd
+// with bench.gd calling print(NoiseBenchmark.new().run()) and quitting.
+//
+// Suites:
+// - "operator": every registered node over FastNoiseLite leaves, in 1D, 2D and 3D, with its operands wrapped in
+//   a NoiseProxy or not;
+// - "reference": the combiners next to the same function called through a std::function, as they were evaluated
+//   before they got compile-time kernels;
+// - "graph": trees of growing depth and width, leaves wrapped in a NoiseProxy or not;
+// - "rescaler": time taken by RescalerNoise to compute its range, against range and step.
+// Sampling suites evaluate points one by one and by batches, on the calling thread and spread on the worker
+// thread pool. The best of several repeats is kept.
+class NoiseBenchmark : public RefCounted {
+	GDCLASS(NoiseBenchmark, RefCounted);
+
+public:
+	enum Format {
+		FORMAT_JSON,
+		FORMAT_CSV,
+	};
+
+	// Graphs with more leaves are skipped.
+	static constexpr int MAX_GRAPH_LEAVES = 256;
+
+public:
+	NoiseBenchmark() {}
+
+	void set_sample_count(int p_count);
+	int get_sample_count() const { return sample_count; }
+
+	void set_repeat_count(int p_count);
+	int get_repeat_count() const { return repeat_count; }
+
+	void set_max_depth(int p_depth);
+	int get_max_depth() const { return max_depth; }
+
+	void set_max_width(int p_width);
+	int get_max_width() const { return max_width; }
+
+	// 0 uses every thread of the pool.
+	void set_thread_count(int p_count);
+	int get_thread_count() const { return thread_count; }
+
+	// Rows of the suites, as dictionaries keyed by the columns returned by get_columns().
+	Array run_suites();
+	String run(Format p_format = FORMAT_JSON);
+
+	static PackedStringArray get_columns();
+	static String format_rows(const Array &p_rows, Format p_format);
+
+protected:
+	static void _bind_methods();
+
+private:
+	struct SamplePass {
+		Ref<Noise> noise;
+		int dimension{ 2 };
+		bool batch{ true };
+		const NoiseBenchmark *benchmark{ nullptr };
+		real_t *values{ nullptr };
+	};
+
+	static constexpr int CHUNK_SIZE = NoiseNode::BATCH_SIZE * 16;
+
+	void _generate_points();
+	void _sample_chunk(uint32_t p_chunk, SamplePass *p_pass);
+	// Best time of the repeats, in nanoseconds per sample.
+	double _measure(const Ref<Noise> &p_noise, int p_dimension, bool p_batch, int p_threads);
+	void _measure_sampling(Array &r_rows, const String &p_suite, const String &p_node, const Ref<Noise> &p_noise, int p_dimension, int p_depth, int p_width, bool p_proxy);
+	void _run_operators(Array &r_rows);
+	void _run_references(Array &r_rows);
+	void _run_graphs(Array &r_rows);
+	void _run_rescaler(Array &r_rows);
+
+	Ref<Noise> _make_node(const String &p_class, int p_dimension, bool p_proxy);
+	Ref<Noise> _make_leaf(bool p_proxy);
+	Ref<Noise> _make_tree(int p_depth, int p_width, bool p_proxy);
+	int _get_pool_threads() const;
+
+private:
+	int sample_count{ 16384 };
+	int repeat_count{ 3 };
+	int max_depth{ 4 };
+	int max_width{ 8 };
+	int thread_count{ 0 };
+
+	LocalVector<real_t> points_1d;
+	LocalVector<Vector2> points_2d;
+	LocalVector<Vector3> points_3d;
+	int leaf_seed{ 0 };
+};
+
+VARIANT_ENUM_CAST(NoiseBenchmark::Format);
+
+#endif
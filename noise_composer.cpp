@@ -24,6 +24,7 @@
 #include "noise_composer.h"
 #include "core/error/error_macros.h"
 #include "core/object/class_db.h"
+#include "core/templates/hashfuncs.h"
 #include <cmath>
 
 void ConstantNoise::_bind_methods() {
@@ -35,15 +36,78 @@ void ConstantNoise::_bind_methods() {
 			"set_value", "get_value");
 }
 
+int ConstantNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_CONSTANT, { value });
+}
+
 void NoiseCombinerOperator::_bind_methods() {
 	REGISTER_NOISE_OPERAND(NoiseCombinerOperator, first_noise, first)
 	REGISTER_NOISE_OPERAND(NoiseCombinerOperator, second_noise, second)
 }
 
+int AddNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_ADD);
+}
+
+int MultiplyNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_MULTIPLY);
+}
+
+int MaxNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_MAX);
+}
+
+int MinNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_MIN);
+}
+
+void PowerNoise::set_approximate(bool p_approximate) {
+	approximate = p_approximate;
+	_changed();
+}
+
+void PowerNoise::_update_cache() {
+	// Strict bounds reduced to a point mean the exponent never changes, whatever the node giving it.
+	const NoiseInterval operand = get_interval(get_operand(1), true);
+	ConstantExponent current;
+	if (get_operand(1).is_valid() && operand.is_point(operand.lower)) {
+		current.constant = true;
+		current.exponent = NoiseKernels::Exponent::make(operand.lower, approximate);
+	}
+	exponent.store(current);
+}
+
+int PowerNoise::emit_instructions(NoiseProgram &p_program) const {
+	const ConstantExponent current = exponent.load();
+	if (!current.constant) {
+		return emit_operator(p_program, NoiseProgram::OP_POWER);
+	}
+	NoiseProgram::Instruction instruction;
+	instruction.op = NoiseProgram::OP_POWER_CONSTANT;
+	instruction.param = { current.exponent.value, real_t(approximate), 0. };
+	instruction.src[0] = p_program.compile(get_operand(0));
+	return p_program.emit(instruction);
+}
+
+void PowerNoise::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_approximate", "approximate"), &PowerNoise::set_approximate);
+	ClassDB::bind_method(D_METHOD("is_approximate"), &PowerNoise::is_approximate);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "approximate"), "set_approximate", "is_approximate");
+}
+
+int AbsoluteNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_ABSOLUTE);
+}
+
 void AbsoluteNoise::_bind_methods() {
 	REGISTER_NOISE_OPERAND(AbsoluteNoise, source, source)
 }
 
+int InvertNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_INVERT);
+}
+
 void InvertNoise::_bind_methods() {
 	REGISTER_NOISE_OPERAND(InvertNoise, source, source)
 }
@@ -51,18 +115,36 @@ void InvertNoise::_bind_methods() {
 void ClampNoise::set_lower_bound(real_t v) {
 	lower_bound = std::min(v, upper_bound);
 	interval = upper_bound - lower_bound;
-	emit_changed();
+	_changed();
 }
 
 void ClampNoise::set_upper_bound(real_t v) {
 	upper_bound = std::max(v, lower_bound);
 	interval = upper_bound - lower_bound;
-	emit_changed();
+	_changed();
 }
 
 void ClampNoise::set_normalized(bool f) {
 	normalize = f;
-	emit_changed();
+	_changed();
+}
+
+void ClampNoise::_update_cache() {
+	// Any value beyond a bound is clamped to that bound, whatever the value.
+	const NoiseInterval source = get_interval(get_operand(0), true);
+	Saturation current;
+	if (source.upper <= lower_bound) {
+		current.saturated = true;
+		current.value = NoiseKernels::clamp(lower_bound, lower_bound, upper_bound, get_normalization_interval());
+	} else if (source.lower >= upper_bound) {
+		current.saturated = true;
+		current.value = NoiseKernels::clamp(upper_bound, lower_bound, upper_bound, get_normalization_interval());
+	}
+	saturation.store(current);
+}
+
+int ClampNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_CLAMP, { lower_bound, upper_bound, get_normalization_interval() });
 }
 
 void ClampNoise::_bind_methods() {
@@ -98,7 +180,98 @@ void CurveNoise::set_curve(Ref<BetterCurve> c) {
 	if (curve.is_valid()) {
 		curve->connect(BetterCurve::SIGNAL_BAKED, callable_mp(this, &CurveNoise::_curve_changed));
 	}
-	emit_changed();
+	_build_lut();
+	_changed();
+}
+
+void CurveNoise::set_lut_resolution(int p_resolution) {
+	lut_resolution = CLAMP(p_resolution, 1, MAX_LUT_RESOLUTION);
+	_build_lut();
+	_changed();
+}
+
+void CurveNoise::set_lut_max_error(real_t p_error) {
+	lut_max_error = MAX(0., p_error);
+	_build_lut();
+	_changed();
+}
+
+void CurveNoise::_build_lut() {
+	Lut lut;
+	if (curve.is_valid()) {
+		lut.resolution = lut_resolution;
+		for (;;) {
+			lut.table.resize(lut.resolution + 1);
+			for (int i = 0; i <= lut.resolution; ++i) {
+				lut.table[i] = curve->sample_baked(real_t(i) / lut.resolution);
+			}
+			// Measured at evenly spaced points within each segment, as the curve may bend anywhere between samples.
+			lut.error = 0.;
+			for (int i = 0; i < lut.resolution; ++i) {
+				for (int j = 1; j < LUT_ERROR_PROBES; ++j) {
+					const real_t weight = real_t(j) / LUT_ERROR_PROBES;
+					const real_t expected = curve->sample_baked((i + weight) / lut.resolution);
+					lut.error = MAX(lut.error, Math::abs(expected - Math::lerp(lut.table[i], lut.table[i + 1], weight)));
+				}
+			}
+			if (lut_max_error <= 0. || lut.error <= lut_max_error) {
+				break;
+			}
+			if (lut.resolution >= MAX_LUT_RESOLUTION) {
+				WARN_PRINT(vformat("The curve table stops at %d segments, %f away from the curve instead of %f.", lut.resolution, lut.error, lut_max_error));
+				break;
+			}
+			lut.resolution = MIN(lut.resolution * 2, MAX_LUT_RESOLUTION);
+		}
+	}
+	luts.write([&](Lut &r_lut) { r_lut = lut; });
+}
+
+real_t CurveNoise::remap(real_t v) const {
+	const NoiseDoubleBuffer<Lut>::Reader lut = luts.read();
+	return lut->resolution > 0 ? NoiseKernels::lookup(v, lut->table.ptr(), lut->resolution) : 0.;
+}
+
+void CurveNoise::remap(const real_t *p_values, real_t *r_values, int p_count) const {
+	const NoiseDoubleBuffer<Lut>::Reader lut = luts.read();
+	if (lut->resolution > 0) {
+		NoiseKernels::lookup(p_values, r_values, p_count, lut->table.ptr(), lut->resolution);
+	} else {
+		std::fill(r_values, r_values + p_count, 0.);
+	}
+}
+
+NoiseInterval CurveNoise::get_value_interval(const NoiseInterval &p_input) const {
+	const NoiseDoubleBuffer<Lut>::Reader lut = luts.read();
+	if (lut->resolution == 0) {
+		return NoiseInterval::point(0.);
+	}
+	// The table is linear between samples, its extremes are at the ends of the input or at the samples between.
+	const real_t *table = lut->table.ptr();
+	const real_t lower = CLAMP(p_input.lower, -1., 1.);
+	const real_t upper = CLAMP(p_input.upper, -1., 1.);
+	NoiseInterval result = NoiseInterval::hull(NoiseInterval::point(NoiseKernels::lookup(lower, table, lut->resolution)),
+			NoiseInterval::point(NoiseKernels::lookup(upper, table, lut->resolution)));
+	const int first = int(Math::ceil((lower + 1.) * lut->resolution / 2.));
+	const int last = int(Math::floor((upper + 1.) * lut->resolution / 2.));
+	for (int i = MAX(first, 0); i <= MIN(last, lut->resolution); ++i) {
+		result = NoiseInterval::hull(result, NoiseInterval::point(table[i]));
+	}
+	return result;
+}
+
+std::array<real_t, 1> CurveNoise::compute_partials(const std::array<real_t, 1> &a) const {
+	const NoiseDoubleBuffer<Lut>::Reader lut = luts.read();
+	if (lut->resolution == 0 || !(a[0] > -1. && a[0] < 1.)) {
+		return { 0. };
+	}
+	// Inputs in [-1, 1] span the resolution segments of the table.
+	const int index = MIN(int((a[0] + 1.) * lut->resolution / 2.), lut->resolution - 1);
+	return { real_t((lut->table[index + 1] - lut->table[index]) * lut->resolution / 2.) };
+}
+
+int CurveNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_CURVE, {}, Ref<Noise>(const_cast<CurveNoise *>(this)));
 }
 
 void CurveNoise::_bind_methods() {
@@ -107,25 +280,38 @@ void CurveNoise::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_curve", "c"), &CurveNoise::set_curve);
 	ClassDB::bind_method(D_METHOD("get_curve"), &CurveNoise::get_curve);
 
+	ClassDB::bind_method(D_METHOD("set_lut_resolution", "resolution"), &CurveNoise::set_lut_resolution);
+	ClassDB::bind_method(D_METHOD("get_lut_resolution"), &CurveNoise::get_lut_resolution);
+	ClassDB::bind_method(D_METHOD("set_lut_max_error", "error"), &CurveNoise::set_lut_max_error);
+	ClassDB::bind_method(D_METHOD("get_lut_max_error"), &CurveNoise::get_lut_max_error);
+	ClassDB::bind_method(D_METHOD("get_lut_size"), &CurveNoise::get_lut_size);
+	ClassDB::bind_method(D_METHOD("get_lut_error"), &CurveNoise::get_lut_error);
+
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "curve",
 						 PROPERTY_HINT_RESOURCE_TYPE, "BetterCurve"),
 			"set_curve", "get_curve");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "lut_resolution", PROPERTY_HINT_RANGE, "1,65536,1"), "set_lut_resolution", "get_lut_resolution");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lut_max_error", PROPERTY_HINT_RANGE, "0,0.1,0.0001"), "set_lut_max_error", "get_lut_max_error");
 }
 
 void AffineNoise::set_scale(real_t s) {
 	scale = s;
-	emit_changed();
+	_changed();
 }
 
 real_t AffineNoise::get_scale() const { return scale; }
 
 void AffineNoise::set_bias(real_t b) {
 	bias = b;
-	emit_changed();
+	_changed();
 }
 
 real_t AffineNoise::get_bias() const { return bias; }
 
+int AffineNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_AFFINE, { scale, bias });
+}
+
 void AffineNoise::_bind_methods() {
 	REGISTER_NOISE_OPERAND(AffineNoise, source, source)
 
@@ -138,6 +324,10 @@ void AffineNoise::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "bias"), "set_bias", "get_bias");
 }
 
+int MixNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_MIX);
+}
+
 void MixNoise::_bind_methods() {
 	REGISTER_NOISE_OPERAND(MixNoise, first_noise, first)
 	REGISTER_NOISE_OPERAND(MixNoise, second_noise, second)
@@ -146,11 +336,15 @@ void MixNoise::_bind_methods() {
 
 void SelectNoise::set_threshold(real_t t) {
 	threshold = t;
-	emit_changed();
+	_changed();
 }
 
 real_t SelectNoise::get_threshold() const { return threshold; }
 
+int SelectNoise::emit_instructions(NoiseProgram &p_program) const {
+	return emit_operator(p_program, NoiseProgram::OP_SELECT, { threshold });
+}
+
 void SelectNoise::_bind_methods() {
 	REGISTER_NOISE_OPERAND(SelectNoise, first_noise, first)
 	REGISTER_NOISE_OPERAND(SelectNoise, second_noise, second)
@@ -164,63 +358,240 @@ void SelectNoise::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "threshold"), "set_threshold", "get_threshold");
 }
 
+NoiseArrayOperator::~NoiseArrayOperator() {
+	for (const Ref<Noise> &noise : noises) {
+		if (noise.is_valid()) {
+			noise->disconnect_changed(callable_mp(this, &NoiseArrayOperator::_changed));
+		}
+	}
+}
+
+void NoiseArrayOperator::set_noises(const TypedArray<Noise> &p_noises) {
+	for (const Ref<Noise> &noise : noises) {
+		if (noise.is_valid()) {
+			noise->disconnect_changed(callable_mp(this, &NoiseArrayOperator::_changed));
+		}
+	}
+	noises.resize(p_noises.size());
+	for (uint32_t i = 0; i < noises.size(); ++i) {
+		noises[i] = p_noises[i];
+		if (noises[i].is_valid()) {
+			noises[i]->connect_changed(callable_mp(this, &NoiseArrayOperator::_changed));
+		}
+	}
+	_set_child_count(noises.size());
+	_changed();
+}
+
+TypedArray<Noise> NoiseArrayOperator::get_noises() const {
+	TypedArray<Noise> result;
+	for (const Ref<Noise> &noise : noises) {
+		result.push_back(noise);
+	}
+	return result;
+}
+
+Ref<Noise> NoiseArrayOperator::get_child(int n) const {
+	return noises[n];
+}
+
+void NoiseArrayOperator::_update_cache() {
+	published.write([&](Operands &r_operands) {
+		r_operands.noises = noises;
+		r_operands.weights.resize(noises.size());
+		for (uint32_t i = 0; i < noises.size(); ++i) {
+			r_operands.weights[i] = _get_weight(i);
+		}
+	});
+}
+
+void NoiseArrayOperator::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_noises", "noises"), &NoiseArrayOperator::set_noises);
+	ClassDB::bind_method(D_METHOD("get_noises"), &NoiseArrayOperator::get_noises);
+
+	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "noises", PROPERTY_HINT_ARRAY_TYPE, "Noise"), "set_noises", "get_noises");
+}
+
+void WeightedSumNoise::set_weights(const PackedFloat32Array &p_weights) {
+	weights = p_weights;
+	_changed();
+}
+
+void WeightedSumNoise::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_weights", "weights"), &WeightedSumNoise::set_weights);
+	ClassDB::bind_method(D_METHOD("get_weights"), &WeightedSumNoise::get_weights);
+
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_FLOAT32_ARRAY, "weights"), "set_weights", "get_weights");
+}
+
 NoiseProxy::~NoiseProxy() {
 	if (source.is_valid()) {
 		source->disconnect_changed(callable_mp(this, &NoiseProxy::_changed));
 	}
 }
 
-real_t NoiseProxy::get_noise_1d(real_t p_x) const {
-	return const_cast<NoiseProxy *>(this)->_get_noise_1d(p_x);
+// In CACHE_LAST_VALUE mode, each thread remembers the last value it got through a proxy, so that the
+// proxies can be shared between threads without locking. Slots are indexed by proxy, and a slot is only valid for the
+// proxy and version that filled it.
+struct NoiseProxyLastValue {
+	uint64_t owner{ 0 };
+	uint32_t version{ 0 };
+	Vector3 coord;
+	real_t value{ 0. };
+};
+
+static constexpr int NOISE_PROXY_SLOTS = 64;
+static thread_local NoiseProxyLastValue noise_proxy_last_1d[NOISE_PROXY_SLOTS];
+static thread_local NoiseProxyLastValue noise_proxy_last_2d[NOISE_PROXY_SLOTS];
+static thread_local NoiseProxyLastValue noise_proxy_last_3d[NOISE_PROXY_SLOTS];
+
+static NoiseProxyLastValue &_get_proxy_slot(NoiseProxyLastValue *p_slots, uint64_t p_owner) {
+	return p_slots[hash_murmur3_one_64(p_owner) % NOISE_PROXY_SLOTS];
 }
 
-real_t NoiseProxy::_get_noise_1d(real_t p_x) {
-	cached_1d &= source.is_valid() && Math::is_equal_approx(p_x, coord_1d);
-	if (!cached_1d) {
-		value_1d = source->get_noise_1d(p_x);
-		coord_1d = p_x;
-		cached_1d = true;
+static NoiseProxyLastValue *_get_proxy_slots(int p_dimension) {
+	switch (p_dimension) {
+		case 1:
+			return noise_proxy_last_1d;
+		case 2:
+			return noise_proxy_last_2d;
+		default:
+			return noise_proxy_last_3d;
 	}
-	return value_1d;
 }
 
-real_t NoiseProxy::get_noise_2dv(Vector2 p_v) const {
-	return get_noise_2d(p_v.x, p_v.y);
+static real_t _sample_source(const Ref<Noise> &p_source, int p_dimension, const Vector3 &p_coord) {
+	switch (p_dimension) {
+		case 1:
+			return p_source->get_noise_1d(p_coord.x);
+		case 2:
+			return p_source->get_noise_2d(p_coord.x, p_coord.y);
+		default:
+			return p_source->get_noise_3d(p_coord.x, p_coord.y, p_coord.z);
+	}
 }
 
-real_t NoiseProxy::get_noise_2d(real_t p_x, real_t p_y) const {
-	return const_cast<NoiseProxy *>(this)->_get_noise_2d(p_x, p_y);
+static Vector3 _to_coord(real_t p_x) {
+	return Vector3(p_x, 0., 0.);
+}
+
+static Vector3 _to_coord(const Vector2 &p_v) {
+	return Vector3(p_v.x, p_v.y, 0.);
+}
+
+static Vector3 _to_coord(const Vector3 &p_v) {
+	return p_v;
+}
+
+template <int D>
+real_t NoiseProxy::_sample(const Vector3 &p_coord) const {
+	NOISE_PROFILE_SCOPE(1);
+	if (source.is_null()) {
+		return 0.;
+	}
+	switch (cache_mode) {
+		case CACHE_DISABLED:
+			return _sample_source(source, D, p_coord);
+		case CACHE_LAST_VALUE: {
+			const uint64_t owner = get_instance_id();
+			const uint32_t current = version.load(std::memory_order_acquire);
+			NoiseProxyLastValue &slot = _get_proxy_slot(_get_proxy_slots(D), owner);
+			bool hit = slot.owner == owner && slot.version == current;
+			for (int i = 0; hit && i < D; ++i) {
+				hit = Math::is_equal_approx(slot.coord[i], p_coord[i]);
+			}
+			NOISE_PROFILE_CACHE(hit ? 1 : 0, hit ? 0 : 1);
+			if (!hit) {
+				slot.value = _sample_source(source, D, p_coord);
+				slot.owner = owner;
+				slot.version = current;
+				slot.coord = p_coord;
+			}
+			return slot.value;
+		}
+		case CACHE_SHARED: {
+			real_t value;
+			uint32_t generation;
+			const bool hit = cache.lookup(D, p_coord, value, generation);
+			NOISE_PROFILE_CACHE(hit ? 1 : 0, hit ? 0 : 1);
+			if (!hit) {
+				value = _sample_source(source, D, p_coord);
+				cache.store(D, p_coord, value, generation);
+			}
+			return value;
+		}
+	}
+	return 0.;
 }
 
-real_t NoiseProxy::_get_noise_2d(real_t p_x, real_t p_y) {
-	cached_2d &= source.is_valid() && Math::is_equal_approx(coord_2d.x, p_x) && Math::is_equal_approx(coord_2d.y, p_y);
-	if (!cached_2d) {
-		value_2d = source->get_noise_2d(p_x, p_y);
-		coord_2d.x = p_x;
-		coord_2d.y = p_y;
-		cached_2d = true;
+template <int D, typename P>
+void NoiseProxy::_sample_batch(const P *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	if (source.is_null() || cache_mode != CACHE_SHARED) {
+		sample_batch(source, p_v, r_values, p_count);
+		return;
 	}
-	return value_2d;
+	// Only the points missing from the cache are sampled, as a single batch.
+	P missed_points[BATCH_SIZE];
+	int missed_index[BATCH_SIZE];
+	real_t missed_values[BATCH_SIZE];
+	uint32_t missed_generations[BATCH_SIZE];
+	for (int offset = 0; offset < p_count; offset += BATCH_SIZE) {
+		const int block = MIN(p_count - offset, BATCH_SIZE);
+		int missed = 0;
+		for (int i = 0; i < block; ++i) {
+			if (!cache.lookup(D, _to_coord(p_v[offset + i]), r_values[offset + i], missed_generations[missed])) {
+				missed_points[missed] = p_v[offset + i];
+				missed_index[missed++] = offset + i;
+			}
+		}
+		NOISE_PROFILE_CACHE(block - missed, missed);
+		if (missed == 0) {
+			continue;
+		}
+		sample_batch(source, missed_points, missed_values, missed);
+		for (int i = 0; i < missed; ++i) {
+			r_values[missed_index[i]] = missed_values[i];
+			cache.store(D, _to_coord(missed_points[i]), missed_values[i], missed_generations[i]);
+		}
+	}
+}
+
+real_t NoiseProxy::get_noise_1d(real_t p_x) const {
+	return _sample<1>(_to_coord(p_x));
+}
+
+real_t NoiseProxy::get_noise_2dv(Vector2 p_v) const {
+	return _sample<2>(_to_coord(p_v));
+}
+
+real_t NoiseProxy::get_noise_2d(real_t p_x, real_t p_y) const {
+	return _sample<2>(Vector3(p_x, p_y, 0.));
 }
 
 real_t NoiseProxy::get_noise_3dv(Vector3 p_v) const {
-	return get_noise_3d(p_v.x, p_v.y, p_v.z);
+	return _sample<3>(p_v);
 }
 
 real_t NoiseProxy::get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const {
-	return const_cast<NoiseProxy *>(this)->_get_noise_3d(p_x, p_y, p_z);
+	return _sample<3>(Vector3(p_x, p_y, p_z));
 }
 
-real_t NoiseProxy::_get_noise_3d(real_t p_x, real_t p_y, real_t p_z) {
-	cached_3d &= source.is_valid() && Math::is_equal_approx(coord_3d.x, p_x) && Math::is_equal_approx(coord_3d.y, p_y) && Math::is_equal_approx(coord_3d.z, p_z);
-	if (!cached_3d) {
-		value_3d = source->get_noise_3d(p_x, p_y, p_z);
-		coord_3d.x = p_x;
-		coord_3d.y = p_y;
-		coord_3d.z = p_z;
-		cached_3d = true;
-	}
-	return value_3d;
+void NoiseProxy::get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const {
+	_sample_batch<1>(p_x, r_values, p_count);
+}
+
+void NoiseProxy::get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	_sample_batch<2>(p_v, r_values, p_count);
+}
+
+void NoiseProxy::get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	_sample_batch<3>(p_v, r_values, p_count);
+}
+
+int NoiseProxy::emit_instructions(NoiseProgram &p_program) const {
+	// The proxy only caches its source, the program can evaluate it directly.
+	return p_program.compile(source);
 }
 
 void NoiseProxy::set_source(Ref<Noise> n) {
@@ -231,7 +602,7 @@ void NoiseProxy::set_source(Ref<Noise> n) {
 		n->connect_changed(callable_mp(this, &NoiseProxy::_changed));
 	}
 	source = n;
-	emit_changed();
+	_changed();
 }
 
 Ref<Noise> NoiseProxy::get_source() const {
@@ -242,20 +613,70 @@ Ref<Noise> NoiseProxy::get_child(int) const {
 	return source;
 }
 
+// The shared table only takes memory in CACHE_SHARED mode.
+void NoiseProxy::_configure_cache(NoiseValueCache::Eviction p_eviction, real_t p_quantization) {
+	cache.configure(cache_mode == CACHE_SHARED ? cache_capacity : 0, p_eviction, p_quantization);
+}
+
+void NoiseProxy::set_cache_mode(CacheMode p_mode) {
+	cache_mode = p_mode;
+	_configure_cache(cache.get_eviction(), cache.get_quantization());
+	_changed();
+}
+
+void NoiseProxy::set_cache_capacity(int p_capacity) {
+	cache_capacity = MAX(p_capacity, 0);
+	_configure_cache(cache.get_eviction(), cache.get_quantization());
+	_changed();
+}
+
+void NoiseProxy::set_cache_eviction(CacheEviction p_eviction) {
+	_configure_cache(static_cast<NoiseValueCache::Eviction>(p_eviction), cache.get_quantization());
+	_changed();
+}
+
+void NoiseProxy::set_cache_quantization(real_t p_quantization) {
+	_configure_cache(cache.get_eviction(), p_quantization);
+	_changed();
+}
+
 void NoiseProxy::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_source", "n"), &NoiseProxy::set_source);
 	ClassDB::bind_method(D_METHOD("get_source"), &NoiseProxy::get_source);
+	ClassDB::bind_method(D_METHOD("set_cache_mode", "mode"), &NoiseProxy::set_cache_mode);
+	ClassDB::bind_method(D_METHOD("get_cache_mode"), &NoiseProxy::get_cache_mode);
+	ClassDB::bind_method(D_METHOD("set_cache_capacity", "capacity"), &NoiseProxy::set_cache_capacity);
+	ClassDB::bind_method(D_METHOD("get_cache_capacity"), &NoiseProxy::get_cache_capacity);
+	ClassDB::bind_method(D_METHOD("set_cache_eviction", "eviction"), &NoiseProxy::set_cache_eviction);
+	ClassDB::bind_method(D_METHOD("get_cache_eviction"), &NoiseProxy::get_cache_eviction);
+	ClassDB::bind_method(D_METHOD("set_cache_quantization", "quantization"), &NoiseProxy::set_cache_quantization);
+	ClassDB::bind_method(D_METHOD("get_cache_quantization"), &NoiseProxy::get_cache_quantization);
+	ClassDB::bind_method(D_METHOD("get_cache_hits"), &NoiseProxy::get_cache_hits);
+	ClassDB::bind_method(D_METHOD("get_cache_misses"), &NoiseProxy::get_cache_misses);
 
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "source",
 						 PROPERTY_HINT_RESOURCE_TYPE, "Noise"),
 			"set_source", "get_source");
+	ADD_GROUP("Cache", "cache_");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_mode", PROPERTY_HINT_ENUM, "Disabled,Last Value,Shared"), "set_cache_mode", "get_cache_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_capacity", PROPERTY_HINT_RANGE, "0,1048576,1,or_greater"), "set_cache_capacity", "get_cache_capacity");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_eviction", PROPERTY_HINT_ENUM, "LRU,FIFO"), "set_cache_eviction", "get_cache_eviction");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cache_quantization", PROPERTY_HINT_RANGE, "0,1,0.0001,or_greater"), "set_cache_quantization", "get_cache_quantization");
+
+	BIND_ENUM_CONSTANT(CACHE_DISABLED);
+	BIND_ENUM_CONSTANT(CACHE_LAST_VALUE);
+	BIND_ENUM_CONSTANT(CACHE_SHARED);
+	BIND_ENUM_CONSTANT(EVICTION_LRU);
+	BIND_ENUM_CONSTANT(EVICTION_FIFO);
 }
 
 real_t NoiseCoordinateRecompute::get_noise_1d(real_t p_x) const {
+	NOISE_PROFILE_SCOPE(1);
 	return inner.is_valid() ? inner->get_noise_1d(transform(p_x)) : 0.;
 }
 
 real_t NoiseCoordinateRecompute::get_noise_2dv(Vector2 p_v) const {
+	NOISE_PROFILE_SCOPE(1);
 	return inner.is_valid() ? inner->get_noise_2dv(transform(p_v)) : 0.;
 }
 
@@ -264,6 +685,7 @@ real_t NoiseCoordinateRecompute::get_noise_2d(real_t p_x, real_t p_y) const {
 }
 
 real_t NoiseCoordinateRecompute::get_noise_3dv(Vector3 p_v) const {
+	NOISE_PROFILE_SCOPE(1);
 	return inner.is_valid() ? inner->get_noise_3dv(transform(p_v)) : 0.;
 }
 
@@ -271,35 +693,97 @@ real_t NoiseCoordinateRecompute::get_noise_3d(real_t p_x, real_t p_y, real_t p_z
 	return get_noise_3dv(Vector3(p_x, p_y, p_z));
 }
 
+void NoiseCoordinateRecompute::get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	LocalVector<real_t> coords;
+	coords.resize(p_count);
+	for (int i = 0; i < p_count; ++i) {
+		coords[i] = transform(p_x[i]);
+	}
+	sample_batch(inner, coords.ptr(), r_values, p_count);
+}
+
+void NoiseCoordinateRecompute::get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	LocalVector<Vector2> coords;
+	coords.resize(p_count);
+	for (int i = 0; i < p_count; ++i) {
+		coords[i] = transform(p_v[i]);
+	}
+	sample_batch(inner, coords.ptr(), r_values, p_count);
+}
+
+void NoiseCoordinateRecompute::get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	LocalVector<Vector3> coords;
+	coords.resize(p_count);
+	for (int i = 0; i < p_count; ++i) {
+		coords[i] = transform(p_v[i]);
+	}
+	sample_batch(inner, coords.ptr(), r_values, p_count);
+}
+
 void NoiseCoordinateRecompute::set_inner_noise(Ref<Noise> n) {
 	if (inner.is_valid()) {
 		inner->disconnect_changed(callable_mp(this, &NoiseCoordinateRecompute::_changed));
 	}
 	inner = n;
 	if (inner.is_valid()) {
-		inner->connect_changed(callable_mp(this, &NoiseCoordinateRecompute::_changed), CONNECT_DEFERRED);
+		inner->connect_changed(callable_mp(this, &NoiseCoordinateRecompute::_changed));
 	}
-	emit_changed();
+	_changed();
 }
 
 void LinearTransformNoise::set_scale(real_t s) {
 	scale = s;
-	emit_changed();
+	_changed();
 }
 
 void LinearTransformNoise::set_bias(real_t b) {
 	bias = b;
-	emit_changed();
+	_changed();
 }
 
 void LinearTransformNoise::set_transform_2d(Transform2D t) {
 	transform_2d = t;
-	emit_changed();
+	_changed();
 }
 
 void LinearTransformNoise::set_transform_3d(Transform3D t) {
 	transform_3d = t;
-	emit_changed();
+	_changed();
+}
+
+real_t LinearTransformNoise::get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const {
+	NOISE_PROFILE_SCOPE(1);
+	const real_t value = get_gradient(get_inner_noise(), transform(p_v), r_gradient);
+	r_gradient = transform_2d.basis_xform_inv(r_gradient);
+	return value;
+}
+
+real_t LinearTransformNoise::get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const {
+	NOISE_PROFILE_SCOPE(1);
+	const real_t value = get_gradient(get_inner_noise(), transform(p_v), r_gradient);
+	r_gradient = transform_3d.basis.xform_inv(r_gradient);
+	return value;
+}
+
+NoiseRegion LinearTransformNoise::transform(const NoiseRegion &p_region) const {
+	NoiseRegion result;
+	switch (p_region.dimension) {
+		case 1:
+			result = NoiseRegion::segment(transform(p_region.box.position.x), transform(p_region.box.position.x + p_region.box.size.x));
+			break;
+		case 2:
+			result = NoiseRegion::rect(transform_2d.xform(Rect2(p_region.box.position.x, p_region.box.position.y, p_region.box.size.x, p_region.box.size.y)));
+			break;
+		default:
+			result = NoiseRegion::volume(transform_3d.xform(p_region.box));
+			break;
+	}
+	// Transformed points are rounded, the region is grown so that they stay inside.
+	result.box = result.box.grow(CMP_EPSILON * (1. + result.box.get_end().abs().length() + result.box.position.abs().length()));
+	return result;
 }
 
 void LinearTransformNoise::_bind_methods() {
@@ -330,27 +814,31 @@ void LinearTransformNoise::_bind_methods() {
 void RescalerNoise::set_noise(Ref<Noise> n) {
 	queue_mutex.lock();
 	if (noise.is_valid()) {
-		noise->disconnect_changed(callable_mp(this, &RescalerNoise::queue_update));
+		noise->disconnect_changed(callable_mp(this, &RescalerNoise::_source_changed));
 	}
 	noise = n;
 	if (noise.is_valid()) {
-		noise->connect_changed(callable_mp(this, &RescalerNoise::queue_update));
+		noise->connect_changed(callable_mp(this, &RescalerNoise::_source_changed));
 	}
 	queue_mutex.unlock();
-	queue_update();
+	_notify_changed();
 }
 
 real_t RescalerNoise::get_scale() const {
-	return is_working() ? 0. : scale;
+	return is_working() ? 0. : coefficients.load().scale;
 }
 
 real_t RescalerNoise::get_bias() const {
-	return bias;
+	return coefficients.load().bias;
 }
 
 real_t RescalerNoise::get_noise_1d(real_t p_x) const {
-	std::shared_lock<std::shared_mutex> lock(*(const_cast<std::shared_mutex *>(&shared_mutex)));
-	return noise.is_valid() ? (noise->get_noise_1d(p_x) * scale) + bias : 0.;
+	NOISE_PROFILE_SCOPE(1);
+	if (noise.is_null()) {
+		return 0.;
+	}
+	const Coefficients affine = coefficients.load();
+	return (noise->get_noise_1d(p_x) * affine.scale) + affine.bias;
 }
 
 real_t RescalerNoise::get_noise_2dv(Vector2 p_v) const {
@@ -358,80 +846,243 @@ real_t RescalerNoise::get_noise_2dv(Vector2 p_v) const {
 }
 
 real_t RescalerNoise::get_noise_2d(real_t p_x, real_t p_y) const {
-	std::shared_lock<std::shared_mutex> lock(*(const_cast<std::shared_mutex *>(&shared_mutex)));
-	return noise.is_valid() ? (noise->get_noise_2d(p_x, p_y) * scale) + bias : 0.;
+	NOISE_PROFILE_SCOPE(1);
+	if (noise.is_null()) {
+		return 0.;
+	}
+	const Coefficients affine = coefficients.load();
+	return (noise->get_noise_2d(p_x, p_y) * affine.scale) + affine.bias;
 }
 
 real_t RescalerNoise::get_noise_3dv(Vector3 p_v) const {
 	return get_noise_3d(p_v.x, p_v.y, p_v.z);
 }
 real_t RescalerNoise::get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const {
-	std::shared_lock<std::shared_mutex> lock(*(const_cast<std::shared_mutex *>(&shared_mutex)));
-	return noise.is_valid() ? (noise->get_noise_3d(p_x, p_y, p_z) * scale) + bias : 0.;
-}
-
-void RescalerNoise::compute_affine_transformation(void *data) {
-	RescalerNoise *rescaler = reinterpret_cast<RescalerNoise *>(data);
-	std::unique_lock<std::shared_mutex> lock(rescaler->shared_mutex);
-
-	if (rescaler->noise.is_valid()) {
-		real_t step = rescaler->step;
-		real_t range = rescaler->range;
-		while (rescaler->update_queued) {
-			rescaler->queue_mutex.lock();
-			rescaler->update_queued = false;
-			rescaler->queue_mutex.unlock();
-
-			real_t value = rescaler->noise->get_noise_2d(0., 0.);
-			real_t min = value, max = value;
-			for (real_t y = 0; y < range; y += step) {
-				for (real_t x = 0; x < range; x += step) {
-					value = rescaler->noise->get_noise_2d(x, y);
-					min = std::min(min, value);
-					max = std::max(max, value);
-				}
-			}
-			real_t diff = max - min;
-			if (Math::is_zero_approx(diff)) {
-				rescaler->scale = 0.;
-				rescaler->bias = 0.;
-			} else {
-				rescaler->scale = 2. / diff;
-				rescaler->bias = -(((2. * min) / diff) + 1.);
-			}
+	NOISE_PROFILE_SCOPE(1);
+	if (noise.is_null()) {
+		return 0.;
+	}
+	const Coefficients affine = coefficients.load();
+	return (noise->get_noise_3d(p_x, p_y, p_z) * affine.scale) + affine.bias;
+}
+
+real_t RescalerNoise::get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const {
+	NOISE_PROFILE_SCOPE(1);
+	if (noise.is_null()) {
+		r_gradient = Vector2();
+		return 0.;
+	}
+	const Coefficients affine = coefficients.load();
+	const real_t value = get_gradient(noise, p_v, r_gradient);
+	r_gradient *= affine.scale;
+	return (value * affine.scale) + affine.bias;
+}
+
+real_t RescalerNoise::get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const {
+	NOISE_PROFILE_SCOPE(1);
+	if (noise.is_null()) {
+		r_gradient = Vector3();
+		return 0.;
+	}
+	const Coefficients affine = coefficients.load();
+	const real_t value = get_gradient(noise, p_v, r_gradient);
+	r_gradient *= affine.scale;
+	return (value * affine.scale) + affine.bias;
+}
+
+void RescalerNoise::get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	sample_batch(noise, p_x, r_values, p_count);
+	_apply_affine(r_values, p_count);
+}
+
+void RescalerNoise::get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	sample_batch(noise, p_v, r_values, p_count);
+	_apply_affine(r_values, p_count);
+}
+
+void RescalerNoise::get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	sample_batch(noise, p_v, r_values, p_count);
+	_apply_affine(r_values, p_count);
+}
+
+void RescalerNoise::_apply_affine(real_t *r_values, int p_count) const {
+	if (noise.is_null()) {
+		return;
+	}
+	const Coefficients affine = coefficients.load();
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = (r_values[i] * affine.scale) + affine.bias;
+	}
+}
+
+// Range computation started by an update. Rows of the sampling grid are spread over the worker thread
+// pool, and the last row to complete reduces the extrema of all rows.
+struct RescalerNoise::UpdatePass {
+	uint64_t generation{ 0 };
+	Ref<Noise> noise;
+	real_t step{ 0. };
+	// The grid is square, with as many columns as rows.
+	int rows{ 0 };
+	LocalVector<real_t> minimums;
+	LocalVector<real_t> maximums;
+	std::atomic<int> completed{ 0 };
+	WorkerThreadPool::GroupID group{ -1 };
+};
+
+void RescalerNoise::_sample_row(uint32_t p_row, UpdatePass *p_pass) {
+	static constexpr int CHUNK_SIZE = BATCH_SIZE * 4;
+	real_t minimum = INFINITY, maximum = -INFINITY;
+	Vector2 points[CHUNK_SIZE];
+	real_t values[CHUNK_SIZE];
+	for (int offset = 0; offset < p_pass->rows; offset += CHUNK_SIZE) {
+		if (generation.load(std::memory_order_relaxed) != p_pass->generation) {
+			break;
 		}
-	} else {
-		rescaler->scale = 0.;
-		rescaler->bias = 0.;
+		const int chunk = MIN(CHUNK_SIZE, p_pass->rows - offset);
+		for (int i = 0; i < chunk; ++i) {
+			points[i] = Vector2((offset + i) * p_pass->step, p_row * p_pass->step);
+		}
+		sample_batch(p_pass->noise, points, values, chunk);
+		for (int i = 0; i < chunk; ++i) {
+			minimum = MIN(minimum, values[i]);
+			maximum = MAX(maximum, values[i]);
+		}
+	}
+	p_pass->minimums[p_row] = minimum;
+	p_pass->maximums[p_row] = maximum;
+	if (p_pass->completed.fetch_add(1, std::memory_order_acq_rel) + 1 == p_pass->rows) {
+		_publish(p_pass);
+	}
+}
+
+void RescalerNoise::_publish(UpdatePass *p_pass) {
+	real_t min = p_pass->minimums[0], max = p_pass->maximums[0];
+	for (int i = 1; i < p_pass->rows; ++i) {
+		min = MIN(min, p_pass->minimums[i]);
+		max = MAX(max, p_pass->maximums[i]);
+	}
+	{
+		// Updates bump the generation with the lock held, so none can store its coefficients in between.
+		MutexLock lock(queue_mutex);
+		if (generation.load(std::memory_order_acquire) != p_pass->generation) {
+			return;
+		}
+		coefficients.store(Coefficients::fit(min, max));
+		working.store(false, std::memory_order_release);
 	}
+	// Queued by id, as the node may be freed before the call runs.
+	callable_mp_static(&RescalerNoise::_finish_update).call_deferred(get_instance_id());
+}
+
+// Runs on the main thread once a pass published its range. Passes whose tasks are over are freed there, the
+// others by a later update or the destructor.
+void RescalerNoise::_finish_update(ObjectID p_id) {
+	Ref<RescalerNoise> rescaler = Object::cast_to<RescalerNoise>(ObjectDB::get_instance(p_id));
+	if (rescaler.is_null()) {
+		return;
+	}
+	rescaler->queue_mutex.lock();
+	rescaler->_reap_passes(false);
+	rescaler->queue_mutex.unlock();
 	rescaler->emit_changed();
 }
 
-void RescalerNoise::queue_update() {
-	queue_mutex.lock();
-	bool start = true;
-	if (update_thread.is_started()) {
-		if (!update_queued) {
-			update_thread.wait_to_finish();
+RescalerNoise::Coefficients RescalerNoise::Coefficients::fit(real_t p_min, real_t p_max) {
+	Coefficients affine;
+	real_t diff = p_max - p_min;
+	if (!Math::is_zero_approx(diff)) {
+		affine.scale = 2. / diff;
+		affine.bias = -(((2. * p_min) / diff) + 1.);
+	}
+	return affine;
+}
+
+void RescalerNoise::_reap_passes(bool p_wait) {
+	for (uint32_t i = 0; i < passes.size();) {
+		UpdatePass *pass = passes[i];
+		if (p_wait || WorkerThreadPool::get_singleton()->is_group_task_completed(pass->group)) {
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(pass->group);
+			memdelete(pass);
+			passes.remove_at_unordered(i);
 		} else {
-			start = false;
+			++i;
 		}
 	}
-	if (start) {
-		update_queued = true;
-		update_thread.start(RescalerNoise::compute_affine_transformation, this);
+}
+
+void RescalerNoise::queue_update() {
+	queue_mutex.lock();
+	// Stale passes notice the new generation and stop, they are collected by a later update.
+	const uint64_t current = generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+	_reap_passes(false);
+	if (noise.is_null() || (mode == MODE_SAMPLED && step <= 0.)) {
+		coefficients.store(Coefficients());
+		working.store(false, std::memory_order_release);
+		queue_mutex.unlock();
+		emit_changed();
+		return;
+	}
+	if (mode == MODE_INTERVAL) {
+		const NoiseInterval interval = get_interval(noise);
+		coefficients.store(interval.is_bounded() ? Coefficients::fit(interval.lower, interval.upper) : Coefficients());
+		working.store(false, std::memory_order_release);
+		queue_mutex.unlock();
+		emit_changed();
+		return;
 	}
+
+	UpdatePass *pass = memnew(UpdatePass);
+	pass->generation = current;
+	pass->noise = noise;
+	pass->step = step;
+	pass->rows = MAX(1, (int)Math::ceil(range / step));
+	pass->minimums.resize(pass->rows);
+	pass->maximums.resize(pass->rows);
+	working.store(true, std::memory_order_release);
+	pass->group = WorkerThreadPool::get_singleton()->add_template_group_task(
+			this, &RescalerNoise::_sample_row, pass, pass->rows, -1, false, SNAME("RescalerNoise"));
+	passes.push_back(pass);
 	queue_mutex.unlock();
 }
 
+real_t RescalerNoise::get_progress() const {
+	MutexLock lock(queue_mutex);
+	if (!is_working() || passes.is_empty()) {
+		return 1.;
+	}
+	const UpdatePass *pass = passes[passes.size() - 1];
+	for (const UpdatePass *p : passes) {
+		if (p->generation > pass->generation) {
+			pass = p;
+		}
+	}
+	return (real_t)pass->completed.load(std::memory_order_relaxed) / pass->rows;
+}
+
 void RescalerNoise::set_range(real_t r) {
 	range = r;
-	queue_update();
+	_notify_changed();
 }
 
 void RescalerNoise::set_step(real_t s) {
 	step = s;
-	queue_update();
+	_notify_changed();
+}
+
+void RescalerNoise::set_mode(Mode p_mode) {
+	mode = p_mode;
+	_notify_changed();
+}
+
+NoiseInterval RescalerNoise::get_region_interval(const NoiseRegion &p_region, bool p_strict) const {
+	if (noise.is_null()) {
+		return NoiseInterval::point(0.);
+	}
+	const Coefficients affine = coefficients.load();
+	return get_interval(noise, p_region, p_strict).map([&](real_t v) { return (v * affine.scale) + affine.bias; });
 }
 
 void RescalerNoise::_bind_methods() {
@@ -440,6 +1091,8 @@ void RescalerNoise::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_scale"), &RescalerNoise::get_scale);
 	ClassDB::bind_method(D_METHOD("get_bias"), &RescalerNoise::get_bias);
+	ClassDB::bind_method(D_METHOD("is_working"), &RescalerNoise::is_working);
+	ClassDB::bind_method(D_METHOD("get_progress"), &RescalerNoise::get_progress);
 
 	ClassDB::bind_method(D_METHOD("set_range", "r"), &RescalerNoise::set_range);
 	ClassDB::bind_method(D_METHOD("get_range"), &RescalerNoise::get_range);
@@ -447,6 +1100,9 @@ void RescalerNoise::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_step", "s"), &RescalerNoise::set_step);
 	ClassDB::bind_method(D_METHOD("get_step"), &RescalerNoise::get_step);
 
+	ClassDB::bind_method(D_METHOD("set_mode", "mode"), &RescalerNoise::set_mode);
+	ClassDB::bind_method(D_METHOD("get_mode"), &RescalerNoise::get_mode);
+
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "noise",
 						 PROPERTY_HINT_RESOURCE_TYPE, "Noise"),
 			"set_noise", "get_noise");
@@ -456,10 +1112,14 @@ void RescalerNoise::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "step", PROPERTY_HINT_RANGE,
 						 "0.01,16.,0.01"),
 			"set_step", "get_step");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "mode", PROPERTY_HINT_ENUM, "Sampled,Interval"), "set_mode", "get_mode");
+
+	BIND_ENUM_CONSTANT(MODE_SAMPLED);
+	BIND_ENUM_CONSTANT(MODE_INTERVAL);
 }
 
+// Passes finishing meanwhile lock the queue to publish, it is not held while waiting for them.
 RescalerNoise::~RescalerNoise() {
-	if (update_thread.is_started()) {
-		update_thread.wait_to_finish();
-	}
+	generation.fetch_add(1, std::memory_order_acq_rel);
+	_reap_passes(true);
 }
\ No newline at end of file
@@ -27,12 +27,15 @@
 #include "core/math/transform_2d.h"
 #include "core/object/object.h"
 #include "core/object/ref_counted.h"
+#include "core/object/worker_thread_pool.h"
 #include "core/os/mutex.h"
-#include "core/os/thread.h"
 #include "modules/curvature/curvature.h"
+#include "noise_kernels.h"
 #include "noise_operator.h"
+#include "noise_sync.h"
+#include "noise_value_cache.h"
 #include <algorithm>
-#include <shared_mutex>
+#include <atomic>
 
 #define DECLARE_NOISE_OPERAND(op_name, op_num)                   \
 	void set_##op_name(Ref<Noise> n) { set_operand(n, op_num); } \
@@ -47,7 +50,7 @@
 						 PROPERTY_HINT_RESOURCE_TYPE, "Noise"),    \
 			"set_" #op_name, "get_" #op_name);
 
-class ConstantNoise : public NaryNoiseOperator<0> {
+class ConstantNoise : public NoiseOperatorKernel<ConstantNoise, NaryNoiseOperator<0>> {
 	GDCLASS(ConstantNoise, NoiseNode);
 	OBJ_SAVE_TYPE(ConstantNoise);
 
@@ -55,13 +58,18 @@ private:
 	real_t value{ 0. };
 
 public:
-	ConstantNoise() :
-			NaryNoiseOperator<0>([&](const std::array<real_t, 0> &) { return value; }) {}
+	ConstantNoise() {}
 	virtual ~ConstantNoise() {}
 
+	real_t compute(const std::array<real_t, 0> &) const { return value; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 0> &) const { return NoiseInterval::point(value); }
+	void compute_batch(const std::array<const real_t *, 0> &, real_t *r_values, int p_count) const { std::fill(r_values, r_values + p_count, value); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	void set_value(real_t v) {
 		value = v;
-		emit_changed();
+		_changed();
 	}
 	real_t get_value() const { return value; }
 
@@ -75,8 +83,7 @@ class NoiseCombinerOperator : public NaryNoiseOperator<2> {
 	GDCLASS(NoiseCombinerOperator, NoiseNode);
 
 public:
-	NoiseCombinerOperator(std::function<real_t(const std::array<real_t, 2> &)> f) :
-			NaryNoiseOperator<2>(f) {}
+	NoiseCombinerOperator() {}
 	virtual ~NoiseCombinerOperator() {}
 
 	DECLARE_NOISE_OPERAND(first_noise, 0)
@@ -86,89 +93,204 @@ protected:
 	static void _bind_methods();
 };
 
-class AddNoise : public NoiseCombinerOperator {
+class AddNoise : public NoiseOperatorKernel<AddNoise, NoiseCombinerOperator> {
 	GDCLASS(AddNoise, NoiseCombinerOperator);
 	OBJ_SAVE_TYPE(AddNoise);
 
 public:
-	AddNoise() :
-			NoiseCombinerOperator([](const std::array<real_t, 2> &a) { return a[0] + a[1]; }) {}
+	AddNoise() {}
 	virtual ~AddNoise() {}
+
+	real_t compute(const std::array<real_t, 2> &a) const { return a[0] + a[1]; }
+	std::array<real_t, 2> compute_partials(const std::array<real_t, 2> &a) const { return { 1., 1. }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 2> &a) const { return NoiseInterval::add(a[0], a[1]); }
+	int prune_operands(const std::array<NoiseInterval, 2> &a) const { return a[1].is_point(0.) ? 0 : (a[0].is_point(0.) ? 1 : PRUNE_NONE); }
+	void compute_batch(const std::array<const real_t *, 2> &a, real_t *r_values, int p_count) const { NoiseKernels::add(a[0], a[1], r_values, p_count); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
 };
 
-class MultiplyNoise : public NoiseCombinerOperator {
+class MultiplyNoise : public NoiseOperatorKernel<MultiplyNoise, NoiseCombinerOperator> {
 	GDCLASS(MultiplyNoise, NoiseCombinerOperator);
 	OBJ_SAVE_TYPE(MultiplyNoise);
 
 public:
-	MultiplyNoise() :
-			NoiseCombinerOperator([](const std::array<real_t, 2> &a) { return a[0] * a[1]; }) {}
+	MultiplyNoise() {}
 	virtual ~MultiplyNoise() {}
+
+	real_t compute(const std::array<real_t, 2> &a) const { return a[0] * a[1]; }
+	std::array<real_t, 2> compute_partials(const std::array<real_t, 2> &a) const { return { a[1], a[0] }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 2> &a) const { return NoiseInterval::multiply(a[0], a[1]); }
+	int prune_operands(const std::array<NoiseInterval, 2> &a) const { return a[1].is_point(1.) ? 0 : (a[0].is_point(1.) ? 1 : PRUNE_NONE); }
+	void compute_batch(const std::array<const real_t *, 2> &a, real_t *r_values, int p_count) const { NoiseKernels::multiply(a[0], a[1], r_values, p_count); }
+
+	// The second operand is not sampled where the first one is zero.
+	template <typename S>
+	real_t evaluate(const S &p_sample) const {
+		real_t first = p_sample(0);
+		real_t second = first == 0. ? 0. : p_sample(1);
+		return first * second;
+	}
+
+	template <typename P>
+	void evaluate_block(const P *p_points, real_t *r_values, int p_count) const {
+		real_t first[BATCH_SIZE], second[BATCH_SIZE];
+		int lanes[BATCH_SIZE];
+		int lane_count = 0;
+		sample_operand_batch(0, p_points, first, p_count);
+		for (int i = 0; i < p_count; ++i) {
+			second[i] = 0.;
+			if (first[i] != 0.) {
+				lanes[lane_count++] = i;
+			}
+		}
+		sample_operand_lanes(1, p_points, lanes, lane_count, p_count, second);
+		NoiseKernels::multiply(first, second, r_values, p_count);
+	}
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
 };
 
-class MaxNoise : public NoiseCombinerOperator {
+class MaxNoise : public NoiseOperatorKernel<MaxNoise, NoiseCombinerOperator> {
 	GDCLASS(MaxNoise, NoiseCombinerOperator);
 	OBJ_SAVE_TYPE(MaxNoise);
 
 public:
-	MaxNoise() :
-			NoiseCombinerOperator([](const std::array<real_t, 2> &a) { return std::max(a[0], a[1]); }) {}
+	MaxNoise() {}
 	virtual ~MaxNoise() {}
+
+	real_t compute(const std::array<real_t, 2> &a) const { return std::max(a[0], a[1]); }
+	std::array<real_t, 2> compute_partials(const std::array<real_t, 2> &a) const { return a[0] < a[1] ? std::array<real_t, 2>{ 0., 1. } : std::array<real_t, 2>{ 1., 0. }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 2> &a) const { return NoiseInterval::max(a[0], a[1]); }
+	int prune_operands(const std::array<NoiseInterval, 2> &a) const { return a[0].lower >= a[1].upper ? 0 : (a[1].lower > a[0].upper ? 1 : PRUNE_NONE); }
+	void compute_batch(const std::array<const real_t *, 2> &a, real_t *r_values, int p_count) const { NoiseKernels::max(a[0], a[1], r_values, p_count); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
 };
 
-class MinNoise : public NoiseCombinerOperator {
+class MinNoise : public NoiseOperatorKernel<MinNoise, NoiseCombinerOperator> {
 	GDCLASS(MinNoise, NoiseCombinerOperator);
 	OBJ_SAVE_TYPE(MinNoise);
 
 public:
-	MinNoise() :
-			NoiseCombinerOperator([](const std::array<real_t, 2> &a) { return std::min(a[0], a[1]); }) {}
+	MinNoise() {}
 	virtual ~MinNoise() {}
+
+	real_t compute(const std::array<real_t, 2> &a) const { return std::min(a[0], a[1]); }
+	std::array<real_t, 2> compute_partials(const std::array<real_t, 2> &a) const { return a[1] < a[0] ? std::array<real_t, 2>{ 0., 1. } : std::array<real_t, 2>{ 1., 0. }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 2> &a) const { return NoiseInterval::min(a[0], a[1]); }
+	int prune_operands(const std::array<NoiseInterval, 2> &a) const { return a[0].upper <= a[1].lower ? 0 : (a[1].upper < a[0].lower ? 1 : PRUNE_NONE); }
+	void compute_batch(const std::array<const real_t *, 2> &a, real_t *r_values, int p_count) const { NoiseKernels::min(a[0], a[1], r_values, p_count); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
 };
 
-class PowerNoise : public NoiseCombinerOperator {
+class PowerNoise : public NoiseOperatorKernel<PowerNoise, NoiseCombinerOperator> {
 	GDCLASS(PowerNoise, NoiseCombinerOperator);
 	OBJ_SAVE_TYPE(PowerNoise);
 
+private:
+	bool approximate{ true };
+
 public:
-	PowerNoise() :
-			NoiseCombinerOperator([](const std::array<real_t, 2> &a) { return std::pow(a[0], a[1]); }) {}
+	PowerNoise() {}
 	virtual ~PowerNoise() {}
+
+	real_t compute(const std::array<real_t, 2> &a) const {
+		const ConstantExponent current = exponent.load();
+		return current.constant ? NoiseKernels::power(a[0], current.exponent) : std::pow(a[0], a[1]);
+	}
+	std::array<real_t, 2> compute_partials(const std::array<real_t, 2> &a) const { return { real_t(a[1] * std::pow(a[0], a[1] - 1.)), real_t(a[0] > 0. ? std::pow(a[0], a[1]) * std::log(a[0]) : 0.) }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 2> &a) const {
+		const ConstantExponent current = exponent.load();
+		return current.constant ? NoiseInterval::power(a[0], current.exponent) : NoiseInterval::power(a[0], a[1]);
+	}
+	int prune_operands(const std::array<NoiseInterval, 2> &a) const { return a[1].is_point(1.) ? 0 : PRUNE_NONE; }
+
+	// A constant exponent is not sampled, the base is raised to it by the kernel picked for its value.
+	template <typename S>
+	real_t evaluate(const S &p_sample) const {
+		const ConstantExponent current = exponent.load();
+		return current.constant ? NoiseKernels::power(p_sample(0), current.exponent) : _evaluate_operands(p_sample);
+	}
+
+	template <typename P>
+	void evaluate_block(const P *p_points, real_t *r_values, int p_count) const {
+		const ConstantExponent current = exponent.load();
+		if (current.constant) {
+			sample_operand_batch(0, p_points, r_values, p_count);
+			NoiseKernels::power(r_values, r_values, p_count, current.exponent);
+		} else {
+			_evaluate_operands_block(p_points, r_values, p_count);
+		}
+	}
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
+	// Whether constant exponents other than integers and 0.5 may use the approximation of the kernels.
+	void set_approximate(bool p_approximate);
+	bool is_approximate() const { return approximate; }
+
+protected:
+	virtual void _update_cache() override;
+
+	static void _bind_methods();
+
+private:
+	struct ConstantExponent {
+		bool constant{ false };
+		NoiseKernels::Exponent exponent;
+	};
+
+	NoiseSnapshot<ConstantExponent> exponent;
 };
 
 // Noise modifiers
 
-class AbsoluteNoise : public NaryNoiseOperator<1> {
+class AbsoluteNoise : public NoiseOperatorKernel<AbsoluteNoise, NaryNoiseOperator<1>> {
 	GDCLASS(AbsoluteNoise, NoiseNode);
 	OBJ_SAVE_TYPE(AbsoluteNoise);
 
 public:
-	AbsoluteNoise() :
-			NaryNoiseOperator<1>([](const std::array<real_t, 1> &a) { return std::abs(a[0]); }) {}
+	AbsoluteNoise() {}
 	virtual ~AbsoluteNoise() {}
 
+	real_t compute(const std::array<real_t, 1> &a) const { return std::abs(a[0]); }
+	std::array<real_t, 1> compute_partials(const std::array<real_t, 1> &a) const { return { real_t(a[0] < 0. ? -1. : (a[0] > 0. ? 1. : 0.)) }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 1> &a) const { return NoiseInterval::absolute(a[0]); }
+	int prune_operands(const std::array<NoiseInterval, 1> &a) const { return a[0].lower >= 0. ? 0 : PRUNE_NONE; }
+	void compute_batch(const std::array<const real_t *, 1> &a, real_t *r_values, int p_count) const { NoiseKernels::absolute(a[0], r_values, p_count); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	DECLARE_NOISE_OPERAND(source, 0)
 
 protected:
 	static void _bind_methods();
 };
 
-class InvertNoise : public NaryNoiseOperator<1> {
+class InvertNoise : public NoiseOperatorKernel<InvertNoise, NaryNoiseOperator<1>> {
 	GDCLASS(InvertNoise, NoiseNode);
 	OBJ_SAVE_TYPE(InvertNoise);
 
 public:
-	InvertNoise() :
-			NaryNoiseOperator<1>([](const std::array<real_t, 1> &a) { return -a[0]; }) {}
+	InvertNoise() {}
 	virtual ~InvertNoise() {}
 
+	real_t compute(const std::array<real_t, 1> &a) const { return -a[0]; }
+	std::array<real_t, 1> compute_partials(const std::array<real_t, 1> &a) const { return { -1. }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 1> &a) const { return NoiseInterval::invert(a[0]); }
+	void compute_batch(const std::array<const real_t *, 1> &a, real_t *r_values, int p_count) const { NoiseKernels::invert(a[0], r_values, p_count); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	DECLARE_NOISE_OPERAND(source, 0)
 
 protected:
 	static void _bind_methods();
 };
 
-class ClampNoise : public NaryNoiseOperator<1> {
+class ClampNoise : public NoiseOperatorKernel<ClampNoise, NaryNoiseOperator<1>> {
 	GDCLASS(ClampNoise, NoiseNode);
 	OBJ_SAVE_TYPE(ClampNoise);
 
@@ -179,15 +301,47 @@ private:
 	bool normalize{ false };
 
 public:
-	ClampNoise() :
-			NaryNoiseOperator<1>(
-					[&](const std::array<real_t, 1> &a) {
-						real_t clamped = std::clamp(a[0], lower_bound, upper_bound);
-						return (normalize && interval != 0.) ? (clamped - lower_bound) / interval : clamped;
-					}) {}
-
+	ClampNoise() {}
 	virtual ~ClampNoise() {}
 
+	real_t compute(const std::array<real_t, 1> &a) const { return NoiseKernels::clamp(a[0], lower_bound, upper_bound, get_normalization_interval()); }
+	std::array<real_t, 1> compute_partials(const std::array<real_t, 1> &a) const {
+		const real_t divisor = get_normalization_interval();
+		return { real_t((a[0] > lower_bound && a[0] < upper_bound) ? 1. / (divisor != 0. ? divisor : 1.) : 0.) };
+	}
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 1> &a) const { return NoiseInterval::clamp(a[0], lower_bound, upper_bound, get_normalization_interval()); }
+	int prune_operands(const std::array<NoiseInterval, 1> &a) const { return !normalize && a[0].is_within(lower_bound, upper_bound) ? 0 : PRUNE_NONE; }
+	void compute_batch(const std::array<const real_t *, 1> &a, real_t *r_values, int p_count) const { NoiseKernels::clamp(a[0], r_values, p_count, lower_bound, upper_bound, get_normalization_interval()); }
+
+	// The source is not sampled at all when its strict bounds are entirely outside the clamping range.
+	template <typename S>
+	real_t evaluate(const S &p_sample) const {
+		const Saturation current = saturation.load();
+		return current.saturated ? current.value : _evaluate_operands(p_sample);
+	}
+
+	template <typename P>
+	void evaluate_block(const P *p_points, real_t *r_values, int p_count) const {
+		const Saturation current = saturation.load();
+		if (current.saturated) {
+			std::fill(r_values, r_values + p_count, current.value);
+		} else {
+			_evaluate_operands_block(p_points, r_values, p_count);
+		}
+	}
+
+	template <typename S, typename G>
+	real_t evaluate_gradient(const S &p_sample, G &r_gradient) const {
+		const Saturation current = saturation.load();
+		if (current.saturated) {
+			r_gradient = G();
+			return current.value;
+		}
+		return NoiseOperatorKernel<ClampNoise, NaryNoiseOperator<1>>::evaluate_gradient(p_sample, r_gradient);
+	}
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	DECLARE_NOISE_OPERAND(source, 0)
 
 	void set_lower_bound(real_t v);
@@ -197,37 +351,93 @@ public:
 	void set_normalized(bool f);
 	bool is_normalized() const { return normalize; }
 
+	// Divisor applied after clamping, zero when the output is not normalized.
+	real_t get_normalization_interval() const { return (normalize && interval != 0.) ? interval : 0.; }
+
 protected:
+	virtual void _update_cache() override;
+
 	static void _bind_methods();
+
+private:
+	struct Saturation {
+		bool saturated{ false };
+		real_t value{ 0. };
+	};
+
+	NoiseSnapshot<Saturation> saturation;
 };
 
-class CurveNoise : public NaryNoiseOperator<1> {
+class CurveNoise : public NoiseOperatorKernel<CurveNoise, NaryNoiseOperator<1>> {
 	GDCLASS(CurveNoise, NoiseNode);
 	OBJ_SAVE_TYPE(CurveNoise);
 
+public:
+	static constexpr int MAX_LUT_RESOLUTION = 65536;
+	// Segments of the table are checked against the curve at this many intervals.
+	static constexpr int LUT_ERROR_PROBES = 8;
+
 private:
 	Ref<BetterCurve> curve;
+	int lut_resolution{ 256 };
+	real_t lut_max_error{ 0.001 };
+
+	// Curve sampled at resolution + 1 evenly spaced inputs, built whenever the curve is baked.
+	struct Lut {
+		LocalVector<real_t> table;
+		int resolution{ 0 };
+		real_t error{ 0. };
+	};
+	NoiseDoubleBuffer<Lut> luts;
 
 public:
-	CurveNoise() :
-			NaryNoiseOperator<1>([&](const std::array<real_t, 1> &a) { return curve.is_valid() ? curve->sample_baked((a[0] + 1.) / 2.) : 0.; }) {}
+	CurveNoise() {}
 	virtual ~CurveNoise() {}
 
+	real_t compute(const std::array<real_t, 1> &a) const { return remap(a[0]); }
+	// Slope of the segment of the table.
+	std::array<real_t, 1> compute_partials(const std::array<real_t, 1> &a) const;
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 1> &a) const { return get_value_interval(a[0]); }
+	void compute_batch(const std::array<const real_t *, 1> &a, real_t *r_values, int p_count) const { remap(a[0], r_values, p_count); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	DECLARE_NOISE_OPERAND(source, 0)
 
 	void set_curve(Ref<BetterCurve> c);
 	Ref<BetterCurve> get_curve() const { return curve; }
 
+	// Number of segments of the table interpolating the curve. Doubled, up to MAX_LUT_RESOLUTION, until the
+	// table stays within the maximum error of the curve; a null maximum error keeps the resolution as set.
+	// The error is only measured at LUT_ERROR_PROBES points per segment, bends between them can escape it.
+	void set_lut_resolution(int p_resolution);
+	int get_lut_resolution() const { return lut_resolution; }
+
+	void set_lut_max_error(real_t p_error);
+	real_t get_lut_max_error() const { return lut_max_error; }
+
+	// Resolution of the current table, and its largest distance to the curve, measured between samples.
+	int get_lut_size() const { return luts.read()->resolution; }
+	real_t get_lut_error() const { return luts.read()->error; }
+
+	real_t remap(real_t v) const;
+	void remap(const real_t *p_values, real_t *r_values, int p_count) const;
+	// Exact bounds of the table over the part of its domain reached by the input.
+	NoiseInterval get_value_interval(const NoiseInterval &p_input) const;
+
 protected:
 	void _curve_changed() {
-		emit_changed();
+		_build_lut();
+		_notify_changed();
 	}
 
+	void _build_lut();
+
 protected:
 	static void _bind_methods();
 };
 
-class AffineNoise : public NaryNoiseOperator<1> {
+class AffineNoise : public NoiseOperatorKernel<AffineNoise, NaryNoiseOperator<1>> {
 	GDCLASS(AffineNoise, NoiseNode);
 	OBJ_SAVE_TYPE(AffineNoise);
 
@@ -236,10 +446,17 @@ private:
 	real_t bias{ 0. };
 
 public:
-	AffineNoise() :
-			NaryNoiseOperator<1>([&](const std::array<real_t, 1> &a) { return (scale * a[0]) + bias; }) {}
+	AffineNoise() {}
 	virtual ~AffineNoise() {}
 
+	real_t compute(const std::array<real_t, 1> &a) const { return (scale * a[0]) + bias; }
+	std::array<real_t, 1> compute_partials(const std::array<real_t, 1> &a) const { return { scale }; }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 1> &a) const { return NoiseInterval::affine(a[0], scale, bias); }
+	int prune_operands(const std::array<NoiseInterval, 1> &a) const { return scale == 1. && bias == 0. ? 0 : PRUNE_NONE; }
+	void compute_batch(const std::array<const real_t *, 1> &a, real_t *r_values, int p_count) const { NoiseKernels::affine(a[0], r_values, p_count, scale, bias); }
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	DECLARE_NOISE_OPERAND(source, 0)
 
 	void set_scale(real_t s);
@@ -254,18 +471,55 @@ protected:
 
 // Noise Selectors
 
-class MixNoise : public NaryNoiseOperator<3> {
+class MixNoise : public NoiseOperatorKernel<MixNoise, NaryNoiseOperator<3>> {
 	GDCLASS(MixNoise, NoiseNode);
 	OBJ_SAVE_TYPE(MixNoise);
 
 public:
-	MixNoise() :
-			NaryNoiseOperator<3>([&](const std::array<real_t, 3> &a) {
-				real_t ratio = (a[2] + 1.) / 2.;
-				return (ratio * a[1]) + ((1. - ratio) * a[0]);
-			}) {}
+	MixNoise() {}
 	virtual ~MixNoise() {}
 
+	real_t compute(const std::array<real_t, 3> &a) const { return NoiseKernels::mix(a[0], a[1], a[2]); }
+	std::array<real_t, 3> compute_partials(const std::array<real_t, 3> &a) const {
+		const real_t ratio = (a[2] + 1.) / 2.;
+		return { real_t(1. - ratio), ratio, real_t((a[1] - a[0]) / 2.) };
+	}
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 3> &a) const { return NoiseInterval::mix(a[0], a[1], a[2]); }
+	int prune_operands(const std::array<NoiseInterval, 3> &a) const { return a[2].is_point(-1.) ? 0 : (a[2].is_point(1.) ? 1 : PRUNE_NONE); }
+	void compute_batch(const std::array<const real_t *, 3> &a, real_t *r_values, int p_count) const { NoiseKernels::mix(a[0], a[1], a[2], r_values, p_count); }
+
+	// The selector is sampled first, an operand whose weight is zero is not sampled.
+	template <typename S>
+	real_t evaluate(const S &p_sample) const {
+		real_t selector = p_sample(2);
+		real_t ratio = (selector + 1.) / 2.;
+		return NoiseKernels::mix(ratio != 1. ? p_sample(0) : 0., ratio != 0. ? p_sample(1) : 0., selector);
+	}
+
+	template <typename P>
+	void evaluate_block(const P *p_points, real_t *r_values, int p_count) const {
+		real_t selector[BATCH_SIZE], first[BATCH_SIZE], second[BATCH_SIZE];
+		int first_lanes[BATCH_SIZE], second_lanes[BATCH_SIZE];
+		int first_count = 0, second_count = 0;
+		sample_operand_batch(2, p_points, selector, p_count);
+		for (int i = 0; i < p_count; ++i) {
+			real_t ratio = (selector[i] + 1.) / 2.;
+			first[i] = 0.;
+			second[i] = 0.;
+			if (ratio != 1.) {
+				first_lanes[first_count++] = i;
+			}
+			if (ratio != 0.) {
+				second_lanes[second_count++] = i;
+			}
+		}
+		sample_operand_lanes(0, p_points, first_lanes, first_count, p_count, first);
+		sample_operand_lanes(1, p_points, second_lanes, second_count, p_count, second);
+		NoiseKernels::mix(first, second, selector, r_values, p_count);
+	}
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	DECLARE_NOISE_OPERAND(first_noise, 0)
 	DECLARE_NOISE_OPERAND(second_noise, 1)
 	DECLARE_NOISE_OPERAND(selector_noise, 2)
@@ -274,7 +528,7 @@ protected:
 	static void _bind_methods();
 };
 
-class SelectNoise : public NaryNoiseOperator<3> {
+class SelectNoise : public NoiseOperatorKernel<SelectNoise, NaryNoiseOperator<3>> {
 	GDCLASS(SelectNoise, NoiseNode);
 	OBJ_SAVE_TYPE(SelectNoise)
 
@@ -282,12 +536,41 @@ private:
 	real_t threshold{ 0. };
 
 public:
-	SelectNoise() :
-			NaryNoiseOperator<3>([&](const std::array<real_t, 3> &a) {
-				return (a[2] < threshold) ? a[0] : a[1];
-			}) {}
+	SelectNoise() {}
 	virtual ~SelectNoise() {}
 
+	real_t compute(const std::array<real_t, 3> &a) const { return NoiseKernels::select(a[0], a[1], a[2], threshold); }
+	NoiseInterval compute_interval(const std::array<NoiseInterval, 3> &a) const { return NoiseInterval::select(a[0], a[1], a[2], threshold); }
+	int prune_operands(const std::array<NoiseInterval, 3> &a) const { return a[2].upper < threshold ? 0 : (a[2].lower >= threshold ? 1 : PRUNE_NONE); }
+	void compute_batch(const std::array<const real_t *, 3> &a, real_t *r_values, int p_count) const { NoiseKernels::select(a[0], a[1], a[2], r_values, p_count, threshold); }
+
+	// The selector is sampled first, only the selected operand is sampled.
+	template <typename S>
+	real_t evaluate(const S &p_sample) const {
+		return p_sample(2) < threshold ? p_sample(0) : p_sample(1);
+	}
+
+	template <typename S, typename G>
+	real_t evaluate_gradient(const S &p_sample, G &r_gradient) const {
+		return p_sample(2, nullptr) < threshold ? p_sample(0, &r_gradient) : p_sample(1, &r_gradient);
+	}
+
+	template <typename P>
+	void evaluate_block(const P *p_points, real_t *r_values, int p_count) const {
+		real_t selector[BATCH_SIZE];
+		int lanes[2][BATCH_SIZE];
+		int counts[2] = { 0, 0 };
+		sample_operand_batch(2, p_points, selector, p_count);
+		for (int i = 0; i < p_count; ++i) {
+			const int branch = selector[i] < threshold ? 0 : 1;
+			lanes[branch][counts[branch]++] = i;
+		}
+		sample_operand_lanes(0, p_points, lanes[0], counts[0], p_count, r_values);
+		sample_operand_lanes(1, p_points, lanes[1], counts[1], p_count, r_values);
+	}
+
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	DECLARE_NOISE_OPERAND(first_noise, 0)
 	DECLARE_NOISE_OPERAND(second_noise, 1)
 	DECLARE_NOISE_OPERAND(selector_noise, 2)
@@ -299,29 +582,172 @@ protected:
 	static void _bind_methods();
 };
 
+// Noise combiners over any number of operands
+
+class MultiAddNoise : public NoiseArrayKernel<MultiAddNoise> {
+	GDCLASS(MultiAddNoise, NoiseArrayOperator);
+	OBJ_SAVE_TYPE(MultiAddNoise);
+
+public:
+	MultiAddNoise() {}
+	virtual ~MultiAddNoise() {}
+
+	static constexpr NoiseProgram::OpCode OPCODE = NoiseProgram::OP_ADD;
+	static real_t combine(real_t a, real_t b) { return a + b; }
+	static void combine_batch(const real_t *a, const real_t *b, real_t *r_values, int p_count) { NoiseKernels::add(a, b, r_values, p_count); }
+	static NoiseInterval combine_interval(const NoiseInterval &a, const NoiseInterval &b) { return NoiseInterval::add(a, b); }
+	static bool dominates(const NoiseInterval &a, const NoiseInterval &b) { return b.is_point(0.); }
+	template <typename G>
+	static real_t combine_gradient(real_t a, G &r_a, real_t b, const G &p_b) {
+		r_a += p_b;
+		return a + b;
+	}
+};
+
+class MultiMultiplyNoise : public NoiseArrayKernel<MultiMultiplyNoise> {
+	GDCLASS(MultiMultiplyNoise, NoiseArrayOperator);
+	OBJ_SAVE_TYPE(MultiMultiplyNoise);
+
+public:
+	MultiMultiplyNoise() {}
+	virtual ~MultiMultiplyNoise() {}
+
+	static constexpr NoiseProgram::OpCode OPCODE = NoiseProgram::OP_MULTIPLY;
+	static real_t combine(real_t a, real_t b) { return a * b; }
+	static void combine_batch(const real_t *a, const real_t *b, real_t *r_values, int p_count) { NoiseKernels::multiply(a, b, r_values, p_count); }
+	static NoiseInterval combine_interval(const NoiseInterval &a, const NoiseInterval &b) { return NoiseInterval::multiply(a, b); }
+	static bool dominates(const NoiseInterval &a, const NoiseInterval &b) { return b.is_point(1.); }
+	template <typename G>
+	static real_t combine_gradient(real_t a, G &r_a, real_t b, const G &p_b) {
+		r_a = (r_a * b) + (p_b * a);
+		return a * b;
+	}
+
+	// Operands following a zero product are not sampled.
+	static bool is_absorbing(real_t p_value) { return p_value == 0.; }
+};
+
+class MultiMaxNoise : public NoiseArrayKernel<MultiMaxNoise> {
+	GDCLASS(MultiMaxNoise, NoiseArrayOperator);
+	OBJ_SAVE_TYPE(MultiMaxNoise);
+
+public:
+	MultiMaxNoise() {}
+	virtual ~MultiMaxNoise() {}
+
+	static constexpr NoiseProgram::OpCode OPCODE = NoiseProgram::OP_MAX;
+	static real_t combine(real_t a, real_t b) { return std::max(a, b); }
+	static void combine_batch(const real_t *a, const real_t *b, real_t *r_values, int p_count) { NoiseKernels::max(a, b, r_values, p_count); }
+	static NoiseInterval combine_interval(const NoiseInterval &a, const NoiseInterval &b) { return NoiseInterval::max(a, b); }
+	static bool dominates(const NoiseInterval &a, const NoiseInterval &b) { return a.lower >= b.upper; }
+	template <typename G>
+	static real_t combine_gradient(real_t a, G &r_a, real_t b, const G &p_b) {
+		if (a < b) {
+			r_a = p_b;
+			return b;
+		}
+		return a;
+	}
+};
+
+class MultiMinNoise : public NoiseArrayKernel<MultiMinNoise> {
+	GDCLASS(MultiMinNoise, NoiseArrayOperator);
+	OBJ_SAVE_TYPE(MultiMinNoise);
+
+public:
+	MultiMinNoise() {}
+	virtual ~MultiMinNoise() {}
+
+	static constexpr NoiseProgram::OpCode OPCODE = NoiseProgram::OP_MIN;
+	static real_t combine(real_t a, real_t b) { return std::min(a, b); }
+	static void combine_batch(const real_t *a, const real_t *b, real_t *r_values, int p_count) { NoiseKernels::min(a, b, r_values, p_count); }
+	static NoiseInterval combine_interval(const NoiseInterval &a, const NoiseInterval &b) { return NoiseInterval::min(a, b); }
+	static bool dominates(const NoiseInterval &a, const NoiseInterval &b) { return a.upper <= b.lower; }
+	template <typename G>
+	static real_t combine_gradient(real_t a, G &r_a, real_t b, const G &p_b) {
+		if (b < a) {
+			r_a = p_b;
+			return b;
+		}
+		return a;
+	}
+};
+
+// Sum of the operands scaled by their weights. Operands without a weight are not scaled.
+class WeightedSumNoise : public NoiseArrayKernel<WeightedSumNoise> {
+	GDCLASS(WeightedSumNoise, NoiseArrayOperator);
+	OBJ_SAVE_TYPE(WeightedSumNoise);
+
+private:
+	PackedFloat32Array weights;
+
+public:
+	WeightedSumNoise() {}
+	virtual ~WeightedSumNoise() {}
+
+	static constexpr NoiseProgram::OpCode OPCODE = NoiseProgram::OP_ADD;
+	static real_t combine(real_t a, real_t b) { return a + b; }
+	static void combine_batch(const real_t *a, const real_t *b, real_t *r_values, int p_count) { NoiseKernels::add(a, b, r_values, p_count); }
+	static NoiseInterval combine_interval(const NoiseInterval &a, const NoiseInterval &b) { return NoiseInterval::add(a, b); }
+	static bool dominates(const NoiseInterval &a, const NoiseInterval &b) { return b.is_point(0.); }
+	template <typename G>
+	static real_t combine_gradient(real_t a, G &r_a, real_t b, const G &p_b) {
+		r_a += p_b;
+		return a + b;
+	}
+
+	void set_weights(const PackedFloat32Array &p_weights);
+	PackedFloat32Array get_weights() const { return weights; }
+
+protected:
+	virtual real_t _get_weight(uint32_t p_index) const override { return p_index < uint32_t(weights.size()) ? real_t(weights[p_index]) : real_t(1.); }
+
+	static void _bind_methods();
+};
+
 // Noise Proxy
 
 class NoiseProxy : public NoiseNode {
 	GDCLASS(NoiseProxy, NoiseNode);
 	OBJ_SAVE_TYPE(NoiseProxy)
 
+public:
+	enum CacheMode {
+		CACHE_DISABLED,
+		// Last value sampled by each thread, the default.
+		CACHE_LAST_VALUE,
+		// Values shared between threads, in a table of cache_capacity entries allocated in this mode only.
+		CACHE_SHARED,
+	};
+
+	// Mirrors NoiseValueCache::Eviction.
+	enum CacheEviction {
+		EVICTION_LRU = NoiseValueCache::EVICTION_LRU,
+		EVICTION_FIFO = NoiseValueCache::EVICTION_FIFO,
+	};
+
 private:
 	Ref<Noise> source;
-	bool cached_1d{ false };
-	bool cached_2d{ false };
-	bool cached_3d{ false };
-	real_t coord_1d{ 0. };
-	Vector2 coord_2d{ 0., 0. };
-	Vector3 coord_3d{ 0., 0., 0. };
-	real_t value_1d{ 0. };
-	real_t value_2d{ 0. };
-	real_t value_3d{ 0. };
+	// Bumped on every change so that values cached by the sampling threads are dropped.
+	std::atomic<uint32_t> version{ 0 };
+	CacheMode cache_mode{ CACHE_LAST_VALUE };
+	int cache_capacity{ 4096 };
+	mutable NoiseValueCache cache;
+
+	void _configure_cache(NoiseValueCache::Eviction p_eviction, real_t p_quantization);
+
+	template <int D>
+	real_t _sample(const Vector3 &p_coord) const;
+	template <int D, typename P>
+	void _sample_batch(const P *p_v, real_t *r_values, int p_count) const;
 
 public:
 	NoiseProxy() :
 			NoiseNode(1) {}
 	virtual ~NoiseProxy();
 
+	virtual int emit_instructions(NoiseProgram &p_program) const override;
+
 	virtual real_t get_noise_1d(real_t p_x) const override;
 
 	virtual real_t get_noise_2dv(Vector2 p_v) const override;
@@ -330,22 +756,44 @@ public:
 	virtual real_t get_noise_3dv(Vector3 p_v) const override;
 	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override;
 
+	virtual void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const override;
+	virtual void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override;
+	virtual void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override;
+
 	virtual Ref<Noise> get_child(int n) const override;
 
+	// Gradients are not cached.
+	virtual real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const override { return get_gradient(source, p_v, r_gradient); }
+	virtual real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const override { return get_gradient(source, p_v, r_gradient); }
+
+	virtual NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override { return get_interval(source, p_region, p_strict); }
+
 	void set_source(Ref<Noise> n);
 	Ref<Noise> get_source() const;
 
+	void set_cache_mode(CacheMode p_mode);
+	CacheMode get_cache_mode() const { return cache_mode; }
+
+	void set_cache_capacity(int p_capacity);
+	int get_cache_capacity() const { return cache_capacity; }
+
+	void set_cache_eviction(CacheEviction p_eviction);
+	CacheEviction get_cache_eviction() const { return static_cast<CacheEviction>(cache.get_eviction()); }
+
+	void set_cache_quantization(real_t p_quantization);
+	real_t get_cache_quantization() const { return cache.get_quantization(); }
+
+	int64_t get_cache_hits() const { return cache.get_hits(); }
+	int64_t get_cache_misses() const { return cache.get_misses(); }
+
 protected:
 	void _changed() {
-		emit_changed();
+		version.fetch_add(1, std::memory_order_release);
+		cache.invalidate();
+		_notify_changed();
 	}
 
 	static void _bind_methods();
-
-private:
-	real_t _get_noise_1d(real_t p_x);
-	real_t _get_noise_2d(real_t p_x, real_t p_y);
-	real_t _get_noise_3d(real_t p_x, real_t p_y, real_t p_z);
 };
 
 class NoiseCoordinateRecompute : public NoiseNode {
@@ -362,8 +810,17 @@ public:
 	virtual real_t get_noise_3dv(Vector3 p_v) const override;
 	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override;
 
+	virtual void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const override;
+	virtual void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override;
+	virtual void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override;
+
 	virtual Ref<Noise> get_child(int) const override { return inner; }
 
+	// Coordinates are transformed, values are left as they are.
+	virtual NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override {
+		return get_interval(inner, p_region.is_bounded() ? transform(p_region) : p_region, p_strict);
+	}
+
 	void set_inner_noise(Ref<Noise> n);
 	Ref<Noise> get_inner_noise() const { return inner; }
 
@@ -371,9 +828,11 @@ protected:
 	virtual real_t transform(real_t s) const = 0;
 	virtual Vector2 transform(Vector2 s) const = 0;
 	virtual Vector3 transform(Vector3 s) const = 0;
+	// Region covering the transformed coordinates of every point of the region.
+	virtual NoiseRegion transform(const NoiseRegion &p_region) const { return NoiseRegion(); }
 
 	void _changed() {
-		emit_changed();
+		_notify_changed();
 	}
 
 private:
@@ -399,12 +858,16 @@ public:
 	void set_transform_3d(Transform3D t);
 	const Transform3D &get_transform_3d() const { return transform_3d; }
 
+	virtual real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const override;
+	virtual real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const override;
+
 protected:
 	static void _bind_methods();
 
 	virtual real_t transform(real_t s) const override { return (s * scale) + bias; }
 	virtual Vector2 transform(Vector2 s) const override { return transform_2d.xform(s); }
 	virtual Vector3 transform(Vector3 s) const override { return transform_3d.xform(s); }
+	virtual NoiseRegion transform(const NoiseRegion &p_region) const override;
 
 private:
 	real_t scale{ 1. };
@@ -417,6 +880,14 @@ class RescalerNoise : public NoiseNode {
 	GDCLASS(RescalerNoise, NoiseNode)
 	OBJ_SAVE_TYPE(RescalerNoise)
 
+public:
+	enum Mode {
+		// Range found by sampling the source over a grid.
+		MODE_SAMPLED,
+		// Range derived at once from the bounds of the source.
+		MODE_INTERVAL,
+	};
+
 public:
 	RescalerNoise() :
 			NoiseNode(1) {}
@@ -425,7 +896,9 @@ public:
 	void set_noise(Ref<Noise> n);
 	Ref<Noise> get_noise() const { return noise; }
 
-	bool is_working() const { return update_thread.is_started(); }
+	bool is_working() const { return working.load(std::memory_order_acquire); }
+	// Completion of the running range computation, between 0 and 1.
+	real_t get_progress() const;
 
 	real_t get_scale() const;
 	real_t get_bias() const;
@@ -436,6 +909,9 @@ public:
 	void set_step(real_t s);
 	real_t get_step() const { return step; }
 
+	void set_mode(Mode p_mode);
+	Mode get_mode() const { return mode; }
+
 	virtual real_t get_noise_1d(real_t p_x) const override;
 
 	virtual real_t get_noise_2dv(Vector2 p_v) const override;
@@ -444,24 +920,58 @@ public:
 	virtual real_t get_noise_3dv(Vector3 p_v) const override;
 	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override;
 
+	virtual void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const override;
+	virtual void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override;
+	virtual void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override;
+
+	virtual real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const override;
+	virtual real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const override;
+
 	virtual Ref<Noise> get_child(int) const override { return noise; }
 
+	virtual NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override;
+
 protected:
 	static void _bind_methods();
 
+	// A change of the source restarts the computation of the range, which notifies the change once done.
+	void _source_changed() { _notify_changed(); }
+	virtual void _flush_changed() override { queue_update(); }
+
 private:
-	static void compute_affine_transformation(void *);
+	struct UpdatePass;
+
+	void _sample_row(uint32_t p_row, UpdatePass *p_pass);
+	void _publish(UpdatePass *p_pass);
+	static void _finish_update(ObjectID p_id);
+	void _reap_passes(bool p_wait);
 	void queue_update();
+	void _apply_affine(real_t *r_values, int p_count) const;
 
 private:
+	struct Coefficients {
+		real_t scale{ 0. };
+		real_t bias{ 0. };
+
+		// Coefficients mapping [p_min, p_max] onto [-1, 1].
+		static Coefficients fit(real_t p_min, real_t p_max);
+	};
+
 	Ref<Noise> noise;
-	real_t scale{ 0. };
-	real_t bias{ 0. };
+	// Published once computed, read by the sampling threads without locking.
+	NoiseSnapshot<Coefficients> coefficients;
 	real_t range{ 16. };
 	real_t step{ 0.5 };
-	bool update_queued{ false };
-	Thread update_thread;
+	Mode mode{ MODE_SAMPLED };
+	// Bumped by every update, the passes started for an older generation stop sampling.
+	std::atomic<uint64_t> generation{ 0 };
+	std::atomic<bool> working{ false };
+	LocalVector<UpdatePass *> passes;
 	Mutex queue_mutex;
-	std::shared_mutex shared_mutex;
 };
-#endif
\ No newline at end of file
+
+VARIANT_ENUM_CAST(NoiseProxy::CacheMode);
+VARIANT_ENUM_CAST(NoiseProxy::CacheEviction);
+VARIANT_ENUM_CAST(RescalerNoise::Mode);
+
+#endif
@@ -0,0 +1,238 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_INTERVAL_H
+#define NOISE_INTERVAL_H
+
+#include "core/math/aabb.h"
+#include "core/math/rect2.h"
+#include "core/math/vector2.h"
+#include "noise_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+// Conservative bounds of the values a noise can take.
+// Every operator has a rule giving the bounds of its result from the bounds of its operands. Bounds are
+// computed with the same floating point operations as the values, so they hold for the rounded values too.
+struct NoiseInterval {
+	real_t lower{ -INFINITY };
+	real_t upper{ INFINITY };
+
+	NoiseInterval() {}
+	NoiseInterval(real_t p_lower, real_t p_upper) :
+			lower{ p_lower }, upper{ p_upper } {}
+
+	static NoiseInterval point(real_t p_value) { return NoiseInterval(p_value, p_value); }
+
+	bool is_bounded() const { return std::isfinite(lower) && std::isfinite(upper); }
+	bool is_within(real_t p_lower, real_t p_upper) const { return lower >= p_lower && upper <= p_upper; }
+	bool is_point(real_t p_value) const { return lower == p_value && upper == p_value; }
+	real_t get_length() const { return upper - lower; }
+	Vector2 to_vector2() const { return Vector2(lower, upper); }
+
+	// Bounds of a monotonic function applied to the interval.
+	template <typename F>
+	NoiseInterval map(F p_function) const {
+		if (!is_bounded()) {
+			return NoiseInterval();
+		}
+		real_t a = p_function(lower), b = p_function(upper);
+		return NoiseInterval(MIN(a, b), MAX(a, b));
+	}
+
+	// Accounts for one more rounding of the bounds.
+	NoiseInterval widened() const {
+		return NoiseInterval(std::nextafter(lower, -INFINITY), std::nextafter(upper, INFINITY));
+	}
+
+	static NoiseInterval hull(const NoiseInterval &p_a, const NoiseInterval &p_b) {
+		return NoiseInterval(MIN(p_a.lower, p_b.lower), MAX(p_a.upper, p_b.upper));
+	}
+
+	static NoiseInterval intersection(const NoiseInterval &p_a, const NoiseInterval &p_b) {
+		return NoiseInterval(MAX(p_a.lower, p_b.lower), MIN(p_a.upper, p_b.upper));
+	}
+
+	static NoiseInterval add(const NoiseInterval &p_a, const NoiseInterval &p_b) {
+		return NoiseInterval(p_a.lower + p_b.lower, p_a.upper + p_b.upper);
+	}
+
+	static NoiseInterval multiply(const NoiseInterval &p_a, const NoiseInterval &p_b) {
+		if (!p_a.is_bounded() || !p_b.is_bounded()) {
+			return NoiseInterval();
+		}
+		const real_t products[4] = { p_a.lower * p_b.lower, p_a.lower * p_b.upper, p_a.upper * p_b.lower, p_a.upper * p_b.upper };
+		return NoiseInterval(*std::min_element(products, products + 4), *std::max_element(products, products + 4));
+	}
+
+	static NoiseInterval max(const NoiseInterval &p_a, const NoiseInterval &p_b) {
+		return NoiseInterval(MAX(p_a.lower, p_b.lower), MAX(p_a.upper, p_b.upper));
+	}
+
+	static NoiseInterval min(const NoiseInterval &p_a, const NoiseInterval &p_b) {
+		return NoiseInterval(MIN(p_a.lower, p_b.lower), MIN(p_a.upper, p_b.upper));
+	}
+
+	static NoiseInterval power(const NoiseInterval &p_base, const NoiseInterval &p_exponent) {
+		if (!p_base.is_bounded() || !p_exponent.is_bounded()) {
+			return NoiseInterval();
+		}
+		if (p_base.lower > 0. || (p_base.lower == 0. && p_exponent.lower > 0.)) {
+			// Monotonic in both arguments for a positive base.
+			const real_t corners[4] = { std::pow(p_base.lower, p_exponent.lower), std::pow(p_base.lower, p_exponent.upper),
+				std::pow(p_base.upper, p_exponent.lower), std::pow(p_base.upper, p_exponent.upper) };
+			return NoiseInterval(*std::min_element(corners, corners + 4), *std::max_element(corners, corners + 4));
+		}
+		const real_t n = p_exponent.lower;
+		if (p_exponent.upper != n || n < 0. || std::floor(n) != n) {
+			// Negative bases with a varying or fractional exponent give NaN or unbounded values.
+			return NoiseInterval();
+		}
+		if (std::fmod(n, (real_t)2.) == 0.) {
+			return absolute(p_base).map([n](real_t v) { return (real_t)std::pow(v, n); });
+		}
+		return p_base.map([n](real_t v) { return (real_t)std::pow(v, n); });
+	}
+
+	// Bounds of the values of the kernel raising the base to a constant exponent, widened by the error of the
+	// way it picked: |exponent| + 2 units in the last place for repeated squaring, the documented relative
+	// error for the approximation, whose results below the smallest normal float are zeros.
+	static NoiseInterval power(const NoiseInterval &p_base, const NoiseKernels::Exponent &p_exponent) {
+		if (p_base.lower == p_base.upper) {
+			return point(NoiseKernels::power(p_base.lower, p_exponent));
+		}
+		const NoiseInterval exact = power(p_base, point(p_exponent.value));
+		const bool identity = p_exponent.mode == NoiseKernels::Exponent::MODE_INTEGER && (p_exponent.integer == 0 || p_exponent.integer == 1);
+		if (!exact.is_bounded() || identity) {
+			return exact;
+		}
+		real_t relative = 0.;
+		switch (p_exponent.mode) {
+			case NoiseKernels::Exponent::MODE_INTEGER:
+				relative = (std::abs(p_exponent.integer) + 2) * std::numeric_limits<real_t>::epsilon();
+				break;
+			case NoiseKernels::Exponent::MODE_APPROXIMATE: {
+				// The exponent of 2 is clamped to [-127, 128] by the approximation.
+				real_t y = 128.;
+				if (p_base.lower > 0.) {
+					y = std::abs(p_exponent.value) * MAX(std::abs(std::log2(p_base.lower)), std::abs(std::log2(p_base.upper)));
+				}
+				relative = NoiseKernels::APPROXIMATE_POWER_ERROR * (1. + MIN(y, real_t(128.)));
+			} break;
+			default:
+				break;
+		}
+		NoiseInterval result(exact.lower - (std::abs(exact.lower) * relative), exact.upper + (std::abs(exact.upper) * relative));
+		if (p_exponent.mode == NoiseKernels::Exponent::MODE_APPROXIMATE && result.lower < real_t(2.) * std::numeric_limits<float>::min()) {
+			result.lower = MIN(result.lower, real_t(0.));
+		}
+		return result.widened();
+	}
+
+	static NoiseInterval absolute(const NoiseInterval &p_a) {
+		if (p_a.lower >= 0.) {
+			return p_a;
+		}
+		if (p_a.upper <= 0.) {
+			return invert(p_a);
+		}
+		return NoiseInterval(0., MAX(-p_a.lower, p_a.upper));
+	}
+
+	static NoiseInterval invert(const NoiseInterval &p_a) {
+		return NoiseInterval(-p_a.upper, -p_a.lower);
+	}
+
+	static NoiseInterval clamp(const NoiseInterval &p_a, real_t p_lower, real_t p_upper, real_t p_interval) {
+		NoiseInterval clamped(std::clamp(p_a.lower, p_lower, p_upper), std::clamp(p_a.upper, p_lower, p_upper));
+		return clamped.map([=](real_t v) { return NoiseKernels::clamp(v, p_lower, p_upper, p_interval); });
+	}
+
+	static NoiseInterval affine(const NoiseInterval &p_a, real_t p_scale, real_t p_bias) {
+		if (p_scale == 0.) {
+			return point(p_bias);
+		}
+		return p_a.map([=](real_t v) { return (p_scale * v) + p_bias; });
+	}
+
+	static NoiseInterval mix(const NoiseInterval &p_first, const NoiseInterval &p_second, const NoiseInterval &p_selector) {
+		if (!p_first.is_bounded() || !p_second.is_bounded() || !p_selector.is_bounded()) {
+			return NoiseInterval();
+		}
+		if (p_selector.is_within(-1., 1.)) {
+			// A convex combination, computed in double precision before the final rounding.
+			return hull(p_first, p_second).widened();
+		}
+		const NoiseInterval ratio = p_selector.map([](real_t v) { return (v + 1.) / 2.; });
+		const NoiseInterval complement = ratio.map([](real_t v) { return 1. - v; });
+		return add(multiply(ratio, p_second), multiply(complement, p_first)).widened();
+	}
+
+	static NoiseInterval select(const NoiseInterval &p_first, const NoiseInterval &p_second, const NoiseInterval &p_selector, real_t p_threshold) {
+		if (p_selector.upper < p_threshold) {
+			return p_first;
+		}
+		if (p_selector.lower >= p_threshold) {
+			return p_second;
+		}
+		return hull(p_first, p_second);
+	}
+};
+
+// Part of the domain of a noise, as a box whose unused axes are flat. The default region is the whole domain.
+struct NoiseRegion {
+	AABB box;
+	// Number of coordinates of the sampled points, 0 when unbounded.
+	int dimension{ 0 };
+
+	NoiseRegion() {}
+
+	static NoiseRegion segment(real_t p_from, real_t p_to) {
+		NoiseRegion region;
+		region.box = AABB(Vector3(MIN(p_from, p_to), 0., 0.), Vector3(Math::abs(p_to - p_from), 0., 0.));
+		region.dimension = 1;
+		return region;
+	}
+
+	static NoiseRegion rect(const Rect2 &p_rect) {
+		const Rect2 rect = p_rect.abs();
+		NoiseRegion region;
+		region.box = AABB(Vector3(rect.position.x, rect.position.y, 0.), Vector3(rect.size.x, rect.size.y, 0.));
+		region.dimension = 2;
+		return region;
+	}
+
+	static NoiseRegion volume(const AABB &p_box) {
+		NoiseRegion region;
+		region.box = p_box.abs();
+		region.dimension = 3;
+		return region;
+	}
+
+	bool is_bounded() const { return dimension > 0; }
+	Vector3 get_center() const { return box.get_center(); }
+	// Largest distance between the center and a point of the region.
+	real_t get_radius() const { return box.size.length() / 2.; }
+};
+
+#endif
@@ -0,0 +1,953 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_kernels.h"
+
+#if !defined(REAL_T_IS_DOUBLE)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NOISE_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NOISE_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+// Scalar
+
+void NoiseKernels::Scalar::add(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = p_a[i] + p_b[i];
+	}
+}
+
+void NoiseKernels::Scalar::multiply(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = p_a[i] * p_b[i];
+	}
+}
+
+void NoiseKernels::Scalar::max(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = std::max(p_a[i], p_b[i]);
+	}
+}
+
+void NoiseKernels::Scalar::min(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = std::min(p_a[i], p_b[i]);
+	}
+}
+
+void NoiseKernels::Scalar::absolute(const real_t *p_a, real_t *r_values, int p_count) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = std::abs(p_a[i]);
+	}
+}
+
+void NoiseKernels::Scalar::invert(const real_t *p_a, real_t *r_values, int p_count) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = -p_a[i];
+	}
+}
+
+void NoiseKernels::Scalar::clamp(const real_t *p_a, real_t *r_values, int p_count, real_t p_lower, real_t p_upper, real_t p_interval) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = NoiseKernels::clamp(p_a[i], p_lower, p_upper, p_interval);
+	}
+}
+
+void NoiseKernels::Scalar::affine(const real_t *p_a, real_t *r_values, int p_count, real_t p_scale, real_t p_bias) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = (p_scale * p_a[i]) + p_bias;
+	}
+}
+
+void NoiseKernels::Scalar::mix(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = NoiseKernels::mix(p_first[i], p_second[i], p_selector[i]);
+	}
+}
+
+void NoiseKernels::Scalar::select(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count, real_t p_threshold) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = NoiseKernels::select(p_first[i], p_second[i], p_selector[i], p_threshold);
+	}
+}
+
+void NoiseKernels::Scalar::power(const real_t *p_a, real_t *r_values, int p_count, const Exponent &p_exponent) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = NoiseKernels::power(p_a[i], p_exponent);
+	}
+}
+
+void NoiseKernels::Scalar::lookup(const real_t *p_a, real_t *r_values, int p_count, const real_t *p_table, int p_size) {
+	for (int i = 0; i < p_count; ++i) {
+		r_values[i] = NoiseKernels::lookup(p_a[i], p_table, p_size);
+	}
+}
+
+// The vector versions below follow the scalar semantics exactly, NaNs aside: when both operands of an
+// operation are NaNs, which one is kept depends on the order the compiler gave to the operands, so the sign
+// and payload of the resulting NaN may differ between implementations.
+// - std::max(a, b) is (a < b) ? b : a, which is maxps(b, a). Same goes for std::min and minps(b, a).
+// - std::clamp(v, lo, hi) is maxps(lo, minps(hi, v)) as long as lo <= hi, which ClampNoise ensures.
+// - The mix ratio is exact in single precision, but the second half of the blend is computed in double
+//   precision by the scalar expression, so it is computed in double here too.
+// - Multiplications and additions are never fused.
+// - Powers repeat the same sequence of operations on every lane, and the selects of approximate_power()
+//   in the same order. std::max(lo, v) is maxps(v, lo) and std::min(hi, v) is minps(v, hi).
+// - Table positions clamp as std::max(0, p) = maxps(p, 0), which also sends NaNs to 0, then
+//   std::min(size, p) = minps(p, size). Truncation to the index is cvttps. Samples are gathered
+//   where the instruction set has no gather.
+
+#ifdef NOISE_KERNELS_X86
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NOISE_TARGET_SSE2 __attribute__((target("sse2")))
+#define NOISE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NOISE_TARGET_SSE2
+#define NOISE_TARGET_AVX2
+#endif
+
+static bool _cpu_has_sse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool _cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	// AVX and OSXSAVE, then whether the OS saves the YMM registers.
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+		return false;
+	}
+	if ((_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// SSE2
+
+NOISE_TARGET_SSE2 static void _sse2_add(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		_mm_storeu_ps(r_values + i, _mm_add_ps(_mm_loadu_ps(p_a + i), _mm_loadu_ps(p_b + i)));
+	}
+	NoiseKernels::Scalar::add(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_multiply(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		_mm_storeu_ps(r_values + i, _mm_mul_ps(_mm_loadu_ps(p_a + i), _mm_loadu_ps(p_b + i)));
+	}
+	NoiseKernels::Scalar::multiply(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_max(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		_mm_storeu_ps(r_values + i, _mm_max_ps(_mm_loadu_ps(p_b + i), _mm_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::max(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_min(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		_mm_storeu_ps(r_values + i, _mm_min_ps(_mm_loadu_ps(p_b + i), _mm_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::min(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_absolute(const real_t *p_a, real_t *r_values, int p_count) {
+	const __m128 sign = _mm_set1_ps(-0.f);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		_mm_storeu_ps(r_values + i, _mm_andnot_ps(sign, _mm_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::absolute(p_a + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_invert(const real_t *p_a, real_t *r_values, int p_count) {
+	const __m128 sign = _mm_set1_ps(-0.f);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		_mm_storeu_ps(r_values + i, _mm_xor_ps(sign, _mm_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::invert(p_a + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_clamp(const real_t *p_a, real_t *r_values, int p_count, real_t p_lower, real_t p_upper, real_t p_interval) {
+	const __m128 lower = _mm_set1_ps(p_lower);
+	const __m128 upper = _mm_set1_ps(p_upper);
+	const __m128 interval = _mm_set1_ps(p_interval);
+	int i = 0;
+	if (p_interval != 0.) {
+		for (; i + 4 <= p_count; i += 4) {
+			__m128 clamped = _mm_max_ps(lower, _mm_min_ps(upper, _mm_loadu_ps(p_a + i)));
+			_mm_storeu_ps(r_values + i, _mm_div_ps(_mm_sub_ps(clamped, lower), interval));
+		}
+	} else {
+		for (; i + 4 <= p_count; i += 4) {
+			_mm_storeu_ps(r_values + i, _mm_max_ps(lower, _mm_min_ps(upper, _mm_loadu_ps(p_a + i))));
+		}
+	}
+	NoiseKernels::Scalar::clamp(p_a + i, r_values + i, p_count - i, p_lower, p_upper, p_interval);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_affine(const real_t *p_a, real_t *r_values, int p_count, real_t p_scale, real_t p_bias) {
+	const __m128 scale = _mm_set1_ps(p_scale);
+	const __m128 bias = _mm_set1_ps(p_bias);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		_mm_storeu_ps(r_values + i, _mm_add_ps(_mm_mul_ps(scale, _mm_loadu_ps(p_a + i)), bias));
+	}
+	NoiseKernels::Scalar::affine(p_a + i, r_values + i, p_count - i, p_scale, p_bias);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_mix(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count) {
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128d one_d = _mm_set1_pd(1.);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		__m128 ratio = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(p_selector + i), one), half);
+		__m128 second = _mm_mul_ps(ratio, _mm_loadu_ps(p_second + i));
+		__m128 first = _mm_loadu_ps(p_first + i);
+
+		__m128d low = _mm_add_pd(_mm_cvtps_pd(second), _mm_mul_pd(_mm_sub_pd(one_d, _mm_cvtps_pd(ratio)), _mm_cvtps_pd(first)));
+		__m128d high = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(second, second)),
+				_mm_mul_pd(_mm_sub_pd(one_d, _mm_cvtps_pd(_mm_movehl_ps(ratio, ratio))), _mm_cvtps_pd(_mm_movehl_ps(first, first))));
+		_mm_storeu_ps(r_values + i, _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high)));
+	}
+	NoiseKernels::Scalar::mix(p_first + i, p_second + i, p_selector + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_select(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count, real_t p_threshold) {
+	const __m128 threshold = _mm_set1_ps(p_threshold);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		__m128 mask = _mm_cmplt_ps(_mm_loadu_ps(p_selector + i), threshold);
+		_mm_storeu_ps(r_values + i, _mm_or_ps(_mm_and_ps(mask, _mm_loadu_ps(p_first + i)), _mm_andnot_ps(mask, _mm_loadu_ps(p_second + i))));
+	}
+	NoiseKernels::Scalar::select(p_first + i, p_second + i, p_selector + i, r_values + i, p_count - i, p_threshold);
+}
+
+NOISE_TARGET_SSE2 static __m128 _sse2_blend(__m128 p_mask, __m128 p_true, __m128 p_false) {
+	return _mm_or_ps(_mm_and_ps(p_mask, p_true), _mm_andnot_ps(p_mask, p_false));
+}
+
+NOISE_TARGET_SSE2 static void _sse2_power(const real_t *p_a, real_t *r_values, int p_count, const NoiseKernels::Exponent &p_exponent) {
+	const __m128 one = _mm_set1_ps(1.f);
+	int i = 0;
+	switch (p_exponent.mode) {
+		case NoiseKernels::Exponent::MODE_INTEGER:
+			for (; i + 4 <= p_count; i += 4) {
+				__m128 result = one;
+				__m128 square = _mm_loadu_ps(p_a + i);
+				for (int n = std::abs(p_exponent.integer); n != 0;) {
+					if (n & 1) {
+						result = _mm_mul_ps(result, square);
+					}
+					n >>= 1;
+					if (n != 0) {
+						square = _mm_mul_ps(square, square);
+					}
+				}
+				_mm_storeu_ps(r_values + i, p_exponent.integer < 0 ? _mm_div_ps(one, result) : result);
+			}
+			break;
+		case NoiseKernels::Exponent::MODE_SQRT:
+			for (; i + 4 <= p_count; i += 4) {
+				_mm_storeu_ps(r_values + i, _mm_sqrt_ps(_mm_loadu_ps(p_a + i)));
+			}
+			break;
+		case NoiseKernels::Exponent::MODE_APPROXIMATE: {
+			const float infinity = std::numeric_limits<float>::infinity();
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 sqrt2 = _mm_set1_ps(NoiseKernels::POWER_SQRT2);
+			const __m128 exponent = _mm_set1_ps(p_exponent.value);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 lowest = _mm_set1_ps(-127.f);
+			const __m128 highest = _mm_set1_ps(128.f);
+			const __m128 underflow = _mm_set1_ps(-126.f);
+			const __m128 normal = _mm_set1_ps(std::numeric_limits<float>::min());
+			const __m128 nan = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+			const __m128 overflow = _mm_set1_ps(infinity);
+			const __m128 of_zero = _mm_set1_ps(p_exponent.value > 0.f ? 0.f : infinity);
+			const __m128 of_infinity = _mm_set1_ps(p_exponent.value > 0.f ? infinity : 0.f);
+			const __m128i bias = _mm_set1_epi32(127);
+			for (; i + 4 <= p_count; i += 4) {
+				const __m128 base = _mm_loadu_ps(p_a + i);
+				const __m128i bits = _mm_castps_si128(base);
+				__m128i whole_exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), bias);
+				__m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+				const __m128 high = _mm_cmpgt_ps(mantissa, sqrt2);
+				mantissa = _sse2_blend(high, _mm_mul_ps(mantissa, half), mantissa);
+				whole_exponent = _mm_sub_epi32(whole_exponent, _mm_castps_si128(high));
+				const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+				const __m128 t2 = _mm_mul_ps(t, t);
+				__m128 log2 = _mm_add_ps(_mm_set1_ps(NoiseKernels::POWER_LOG2[2]), _mm_mul_ps(t2, _mm_set1_ps(NoiseKernels::POWER_LOG2[3])));
+				log2 = _mm_add_ps(_mm_set1_ps(NoiseKernels::POWER_LOG2[1]), _mm_mul_ps(t2, log2));
+				log2 = _mm_add_ps(_mm_set1_ps(NoiseKernels::POWER_LOG2[0]), _mm_mul_ps(t2, log2));
+				log2 = _mm_add_ps(_mm_cvtepi32_ps(whole_exponent), _mm_mul_ps(t, log2));
+
+				const __m128 y = _mm_min_ps(_mm_max_ps(_mm_mul_ps(exponent, log2), lowest), highest);
+				__m128i whole = _mm_cvttps_epi32(y);
+				whole = _mm_add_epi32(whole, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(whole), y)));
+				const __m128 f = _mm_sub_ps(y, _mm_cvtepi32_ps(whole));
+				__m128 fraction = _mm_set1_ps(NoiseKernels::POWER_EXP2[8]);
+				for (int j = 7; j >= 0; --j) {
+					fraction = _mm_add_ps(_mm_set1_ps(NoiseKernels::POWER_EXP2[j]), _mm_mul_ps(f, fraction));
+				}
+				fraction = _mm_add_ps(one, _mm_mul_ps(f, fraction));
+				const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, bias), 23));
+
+				__m128 result = _mm_mul_ps(fraction, scale);
+				result = _sse2_blend(_mm_cmpge_ps(y, highest), overflow, result);
+				result = _sse2_blend(_mm_cmplt_ps(y, underflow), zero, result);
+				result = _sse2_blend(_mm_cmplt_ps(base, normal), of_zero, result);
+				result = _sse2_blend(_mm_cmplt_ps(base, zero), nan, result);
+				result = _sse2_blend(_mm_cmpeq_ps(base, overflow), of_infinity, result);
+				result = _sse2_blend(_mm_cmpunord_ps(base, base), base, result);
+				_mm_storeu_ps(r_values + i, result);
+			}
+		} break;
+		default:
+			break;
+	}
+	NoiseKernels::Scalar::power(p_a + i, r_values + i, p_count - i, p_exponent);
+}
+
+NOISE_TARGET_SSE2 static void _sse2_lookup(const real_t *p_a, real_t *r_values, int p_count, const real_t *p_table, int p_size) {
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 scale = _mm_set1_ps(0.5f * p_size);
+	const __m128 size = _mm_set1_ps(p_size);
+	const __m128i last = _mm_set1_epi32(p_size - 1);
+	alignas(16) int32_t indices[4];
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		__m128 position = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(p_a + i), one), scale), zero), size);
+		__m128i index = _mm_cvttps_epi32(position);
+		// No integer min before SSE4.1.
+		__m128i over = _mm_cmpgt_epi32(index, last);
+		index = _mm_or_si128(_mm_and_si128(over, last), _mm_andnot_si128(over, index));
+		__m128 fraction = _mm_sub_ps(position, _mm_cvtepi32_ps(index));
+		_mm_store_si128(reinterpret_cast<__m128i *>(indices), index);
+		__m128 low = _mm_setr_ps(p_table[indices[0]], p_table[indices[1]], p_table[indices[2]], p_table[indices[3]]);
+		__m128 high = _mm_setr_ps(p_table[indices[0] + 1], p_table[indices[1] + 1], p_table[indices[2] + 1], p_table[indices[3] + 1]);
+		_mm_storeu_ps(r_values + i, _mm_add_ps(low, _mm_mul_ps(fraction, _mm_sub_ps(high, low))));
+	}
+	NoiseKernels::Scalar::lookup(p_a + i, r_values + i, p_count - i, p_table, p_size);
+}
+
+// AVX2
+
+NOISE_TARGET_AVX2 static void _avx2_add(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		_mm256_storeu_ps(r_values + i, _mm256_add_ps(_mm256_loadu_ps(p_a + i), _mm256_loadu_ps(p_b + i)));
+	}
+	NoiseKernels::Scalar::add(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_multiply(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		_mm256_storeu_ps(r_values + i, _mm256_mul_ps(_mm256_loadu_ps(p_a + i), _mm256_loadu_ps(p_b + i)));
+	}
+	NoiseKernels::Scalar::multiply(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_max(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		_mm256_storeu_ps(r_values + i, _mm256_max_ps(_mm256_loadu_ps(p_b + i), _mm256_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::max(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_min(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		_mm256_storeu_ps(r_values + i, _mm256_min_ps(_mm256_loadu_ps(p_b + i), _mm256_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::min(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_absolute(const real_t *p_a, real_t *r_values, int p_count) {
+	const __m256 sign = _mm256_set1_ps(-0.f);
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		_mm256_storeu_ps(r_values + i, _mm256_andnot_ps(sign, _mm256_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::absolute(p_a + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_invert(const real_t *p_a, real_t *r_values, int p_count) {
+	const __m256 sign = _mm256_set1_ps(-0.f);
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		_mm256_storeu_ps(r_values + i, _mm256_xor_ps(sign, _mm256_loadu_ps(p_a + i)));
+	}
+	NoiseKernels::Scalar::invert(p_a + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_clamp(const real_t *p_a, real_t *r_values, int p_count, real_t p_lower, real_t p_upper, real_t p_interval) {
+	const __m256 lower = _mm256_set1_ps(p_lower);
+	const __m256 upper = _mm256_set1_ps(p_upper);
+	const __m256 interval = _mm256_set1_ps(p_interval);
+	int i = 0;
+	if (p_interval != 0.) {
+		for (; i + 8 <= p_count; i += 8) {
+			__m256 clamped = _mm256_max_ps(lower, _mm256_min_ps(upper, _mm256_loadu_ps(p_a + i)));
+			_mm256_storeu_ps(r_values + i, _mm256_div_ps(_mm256_sub_ps(clamped, lower), interval));
+		}
+	} else {
+		for (; i + 8 <= p_count; i += 8) {
+			_mm256_storeu_ps(r_values + i, _mm256_max_ps(lower, _mm256_min_ps(upper, _mm256_loadu_ps(p_a + i))));
+		}
+	}
+	NoiseKernels::Scalar::clamp(p_a + i, r_values + i, p_count - i, p_lower, p_upper, p_interval);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_affine(const real_t *p_a, real_t *r_values, int p_count, real_t p_scale, real_t p_bias) {
+	const __m256 scale = _mm256_set1_ps(p_scale);
+	const __m256 bias = _mm256_set1_ps(p_bias);
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		_mm256_storeu_ps(r_values + i, _mm256_add_ps(_mm256_mul_ps(scale, _mm256_loadu_ps(p_a + i)), bias));
+	}
+	NoiseKernels::Scalar::affine(p_a + i, r_values + i, p_count - i, p_scale, p_bias);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_mix(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count) {
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256d one_d = _mm256_set1_pd(1.);
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		__m256 ratio = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(p_selector + i), one), half);
+		__m256 second = _mm256_mul_ps(ratio, _mm256_loadu_ps(p_second + i));
+		__m256 first = _mm256_loadu_ps(p_first + i);
+
+		__m256d low = _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(second)),
+				_mm256_mul_pd(_mm256_sub_pd(one_d, _mm256_cvtps_pd(_mm256_castps256_ps128(ratio))), _mm256_cvtps_pd(_mm256_castps256_ps128(first))));
+		__m256d high = _mm256_add_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(second, 1)),
+				_mm256_mul_pd(_mm256_sub_pd(one_d, _mm256_cvtps_pd(_mm256_extractf128_ps(ratio, 1))), _mm256_cvtps_pd(_mm256_extractf128_ps(first, 1))));
+		_mm256_storeu_ps(r_values + i, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(low)), _mm256_cvtpd_ps(high), 1));
+	}
+	NoiseKernels::Scalar::mix(p_first + i, p_second + i, p_selector + i, r_values + i, p_count - i);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_select(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count, real_t p_threshold) {
+	const __m256 threshold = _mm256_set1_ps(p_threshold);
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		__m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(p_selector + i), threshold, _CMP_LT_OQ);
+		_mm256_storeu_ps(r_values + i, _mm256_blendv_ps(_mm256_loadu_ps(p_second + i), _mm256_loadu_ps(p_first + i), mask));
+	}
+	NoiseKernels::Scalar::select(p_first + i, p_second + i, p_selector + i, r_values + i, p_count - i, p_threshold);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_power(const real_t *p_a, real_t *r_values, int p_count, const NoiseKernels::Exponent &p_exponent) {
+	const __m256 one = _mm256_set1_ps(1.f);
+	int i = 0;
+	switch (p_exponent.mode) {
+		case NoiseKernels::Exponent::MODE_INTEGER:
+			for (; i + 8 <= p_count; i += 8) {
+				__m256 result = one;
+				__m256 square = _mm256_loadu_ps(p_a + i);
+				for (int n = std::abs(p_exponent.integer); n != 0;) {
+					if (n & 1) {
+						result = _mm256_mul_ps(result, square);
+					}
+					n >>= 1;
+					if (n != 0) {
+						square = _mm256_mul_ps(square, square);
+					}
+				}
+				_mm256_storeu_ps(r_values + i, p_exponent.integer < 0 ? _mm256_div_ps(one, result) : result);
+			}
+			break;
+		case NoiseKernels::Exponent::MODE_SQRT:
+			for (; i + 8 <= p_count; i += 8) {
+				_mm256_storeu_ps(r_values + i, _mm256_sqrt_ps(_mm256_loadu_ps(p_a + i)));
+			}
+			break;
+		case NoiseKernels::Exponent::MODE_APPROXIMATE: {
+			const float infinity = std::numeric_limits<float>::infinity();
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256 sqrt2 = _mm256_set1_ps(NoiseKernels::POWER_SQRT2);
+			const __m256 exponent = _mm256_set1_ps(p_exponent.value);
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 lowest = _mm256_set1_ps(-127.f);
+			const __m256 highest = _mm256_set1_ps(128.f);
+			const __m256 underflow = _mm256_set1_ps(-126.f);
+			const __m256 normal = _mm256_set1_ps(std::numeric_limits<float>::min());
+			const __m256 nan = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+			const __m256 overflow = _mm256_set1_ps(infinity);
+			const __m256 of_zero = _mm256_set1_ps(p_exponent.value > 0.f ? 0.f : infinity);
+			const __m256 of_infinity = _mm256_set1_ps(p_exponent.value > 0.f ? infinity : 0.f);
+			const __m256i bias = _mm256_set1_epi32(127);
+			for (; i + 8 <= p_count; i += 8) {
+				const __m256 base = _mm256_loadu_ps(p_a + i);
+				const __m256i bits = _mm256_castps_si256(base);
+				__m256i whole_exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias);
+				__m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+				const __m256 high = _mm256_cmp_ps(mantissa, sqrt2, _CMP_GT_OQ);
+				mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, half), high);
+				whole_exponent = _mm256_sub_epi32(whole_exponent, _mm256_castps_si256(high));
+				const __m256 t = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+				const __m256 t2 = _mm256_mul_ps(t, t);
+				__m256 log2 = _mm256_add_ps(_mm256_set1_ps(NoiseKernels::POWER_LOG2[2]), _mm256_mul_ps(t2, _mm256_set1_ps(NoiseKernels::POWER_LOG2[3])));
+				log2 = _mm256_add_ps(_mm256_set1_ps(NoiseKernels::POWER_LOG2[1]), _mm256_mul_ps(t2, log2));
+				log2 = _mm256_add_ps(_mm256_set1_ps(NoiseKernels::POWER_LOG2[0]), _mm256_mul_ps(t2, log2));
+				log2 = _mm256_add_ps(_mm256_cvtepi32_ps(whole_exponent), _mm256_mul_ps(t, log2));
+
+				const __m256 y = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(exponent, log2), lowest), highest);
+				__m256i whole = _mm256_cvttps_epi32(y);
+				whole = _mm256_add_epi32(whole, _mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(whole), y, _CMP_GT_OQ)));
+				const __m256 f = _mm256_sub_ps(y, _mm256_cvtepi32_ps(whole));
+				__m256 fraction = _mm256_set1_ps(NoiseKernels::POWER_EXP2[8]);
+				for (int j = 7; j >= 0; --j) {
+					fraction = _mm256_add_ps(_mm256_set1_ps(NoiseKernels::POWER_EXP2[j]), _mm256_mul_ps(f, fraction));
+				}
+				fraction = _mm256_add_ps(one, _mm256_mul_ps(f, fraction));
+				const __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(whole, bias), 23));
+
+				__m256 result = _mm256_mul_ps(fraction, scale);
+				result = _mm256_blendv_ps(result, overflow, _mm256_cmp_ps(y, highest, _CMP_GE_OQ));
+				result = _mm256_blendv_ps(result, zero, _mm256_cmp_ps(y, underflow, _CMP_LT_OQ));
+				result = _mm256_blendv_ps(result, of_zero, _mm256_cmp_ps(base, normal, _CMP_LT_OQ));
+				result = _mm256_blendv_ps(result, nan, _mm256_cmp_ps(base, zero, _CMP_LT_OQ));
+				result = _mm256_blendv_ps(result, of_infinity, _mm256_cmp_ps(base, overflow, _CMP_EQ_OQ));
+				result = _mm256_blendv_ps(result, base, _mm256_cmp_ps(base, base, _CMP_UNORD_Q));
+				_mm256_storeu_ps(r_values + i, result);
+			}
+		} break;
+		default:
+			break;
+	}
+	NoiseKernels::Scalar::power(p_a + i, r_values + i, p_count - i, p_exponent);
+}
+
+NOISE_TARGET_AVX2 static void _avx2_lookup(const real_t *p_a, real_t *r_values, int p_count, const real_t *p_table, int p_size) {
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 scale = _mm256_set1_ps(0.5f * p_size);
+	const __m256 size = _mm256_set1_ps(p_size);
+	const __m256i last = _mm256_set1_epi32(p_size - 1);
+	int i = 0;
+	for (; i + 8 <= p_count; i += 8) {
+		__m256 position = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(p_a + i), one), scale), zero), size);
+		__m256i index = _mm256_min_epi32(_mm256_cvttps_epi32(position), last);
+		__m256 fraction = _mm256_sub_ps(position, _mm256_cvtepi32_ps(index));
+		__m256 low = _mm256_i32gather_ps(p_table, index, sizeof(float));
+		__m256 high = _mm256_i32gather_ps(p_table + 1, index, sizeof(float));
+		_mm256_storeu_ps(r_values + i, _mm256_add_ps(low, _mm256_mul_ps(fraction, _mm256_sub_ps(high, low))));
+	}
+	NoiseKernels::Scalar::lookup(p_a + i, r_values + i, p_count - i, p_table, p_size);
+}
+
+#endif // NOISE_KERNELS_X86
+
+#ifdef NOISE_KERNELS_NEON
+
+static void _neon_add(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		vst1q_f32(r_values + i, vaddq_f32(vld1q_f32(p_a + i), vld1q_f32(p_b + i)));
+	}
+	NoiseKernels::Scalar::add(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+static void _neon_multiply(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		vst1q_f32(r_values + i, vmulq_f32(vld1q_f32(p_a + i), vld1q_f32(p_b + i)));
+	}
+	NoiseKernels::Scalar::multiply(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+// vmaxq/vminq propagate NaNs differently from std::max/std::min, hence the compare and select.
+static void _neon_max(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		float32x4_t a = vld1q_f32(p_a + i);
+		float32x4_t b = vld1q_f32(p_b + i);
+		vst1q_f32(r_values + i, vbslq_f32(vcltq_f32(a, b), b, a));
+	}
+	NoiseKernels::Scalar::max(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+static void _neon_min(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		float32x4_t a = vld1q_f32(p_a + i);
+		float32x4_t b = vld1q_f32(p_b + i);
+		vst1q_f32(r_values + i, vbslq_f32(vcltq_f32(b, a), b, a));
+	}
+	NoiseKernels::Scalar::min(p_a + i, p_b + i, r_values + i, p_count - i);
+}
+
+static void _neon_absolute(const real_t *p_a, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		vst1q_f32(r_values + i, vabsq_f32(vld1q_f32(p_a + i)));
+	}
+	NoiseKernels::Scalar::absolute(p_a + i, r_values + i, p_count - i);
+}
+
+static void _neon_invert(const real_t *p_a, real_t *r_values, int p_count) {
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		vst1q_f32(r_values + i, vnegq_f32(vld1q_f32(p_a + i)));
+	}
+	NoiseKernels::Scalar::invert(p_a + i, r_values + i, p_count - i);
+}
+
+static void _neon_clamp(const real_t *p_a, real_t *r_values, int p_count, real_t p_lower, real_t p_upper, real_t p_interval) {
+	const float32x4_t lower = vdupq_n_f32(p_lower);
+	const float32x4_t upper = vdupq_n_f32(p_upper);
+	const float32x4_t interval = vdupq_n_f32(p_interval);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		float32x4_t v = vld1q_f32(p_a + i);
+		float32x4_t clamped = vbslq_f32(vcltq_f32(upper, v), upper, v);
+		clamped = vbslq_f32(vcltq_f32(v, lower), lower, clamped);
+		if (p_interval != 0.) {
+			clamped = vdivq_f32(vsubq_f32(clamped, lower), interval);
+		}
+		vst1q_f32(r_values + i, clamped);
+	}
+	NoiseKernels::Scalar::clamp(p_a + i, r_values + i, p_count - i, p_lower, p_upper, p_interval);
+}
+
+static void _neon_affine(const real_t *p_a, real_t *r_values, int p_count, real_t p_scale, real_t p_bias) {
+	const float32x4_t scale = vdupq_n_f32(p_scale);
+	const float32x4_t bias = vdupq_n_f32(p_bias);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		vst1q_f32(r_values + i, vaddq_f32(vmulq_f32(scale, vld1q_f32(p_a + i)), bias));
+	}
+	NoiseKernels::Scalar::affine(p_a + i, r_values + i, p_count - i, p_scale, p_bias);
+}
+
+static void _neon_mix(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count) {
+	const float32x4_t one = vdupq_n_f32(1.f);
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	const float64x2_t one_d = vdupq_n_f64(1.);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		float32x4_t ratio = vmulq_f32(vaddq_f32(vld1q_f32(p_selector + i), one), half);
+		float32x4_t second = vmulq_f32(ratio, vld1q_f32(p_second + i));
+		float32x4_t first = vld1q_f32(p_first + i);
+
+		float64x2_t low = vaddq_f64(vcvt_f64_f32(vget_low_f32(second)),
+				vmulq_f64(vsubq_f64(one_d, vcvt_f64_f32(vget_low_f32(ratio))), vcvt_f64_f32(vget_low_f32(first))));
+		float64x2_t high = vaddq_f64(vcvt_high_f64_f32(second),
+				vmulq_f64(vsubq_f64(one_d, vcvt_high_f64_f32(ratio)), vcvt_high_f64_f32(first)));
+		vst1q_f32(r_values + i, vcvt_high_f32_f64(vcvt_f32_f64(low), high));
+	}
+	NoiseKernels::Scalar::mix(p_first + i, p_second + i, p_selector + i, r_values + i, p_count - i);
+}
+
+static void _neon_select(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count, real_t p_threshold) {
+	const float32x4_t threshold = vdupq_n_f32(p_threshold);
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		uint32x4_t mask = vcltq_f32(vld1q_f32(p_selector + i), threshold);
+		vst1q_f32(r_values + i, vbslq_f32(mask, vld1q_f32(p_first + i), vld1q_f32(p_second + i)));
+	}
+	NoiseKernels::Scalar::select(p_first + i, p_second + i, p_selector + i, r_values + i, p_count - i, p_threshold);
+}
+
+static void _neon_power(const real_t *p_a, real_t *r_values, int p_count, const NoiseKernels::Exponent &p_exponent) {
+	const float32x4_t one = vdupq_n_f32(1.f);
+	int i = 0;
+	switch (p_exponent.mode) {
+		case NoiseKernels::Exponent::MODE_INTEGER:
+			for (; i + 4 <= p_count; i += 4) {
+				float32x4_t result = one;
+				float32x4_t square = vld1q_f32(p_a + i);
+				for (int n = std::abs(p_exponent.integer); n != 0;) {
+					if (n & 1) {
+						result = vmulq_f32(result, square);
+					}
+					n >>= 1;
+					if (n != 0) {
+						square = vmulq_f32(square, square);
+					}
+				}
+				vst1q_f32(r_values + i, p_exponent.integer < 0 ? vdivq_f32(one, result) : result);
+			}
+			break;
+		case NoiseKernels::Exponent::MODE_SQRT:
+			for (; i + 4 <= p_count; i += 4) {
+				vst1q_f32(r_values + i, vsqrtq_f32(vld1q_f32(p_a + i)));
+			}
+			break;
+		case NoiseKernels::Exponent::MODE_APPROXIMATE: {
+			const float infinity = std::numeric_limits<float>::infinity();
+			const float32x4_t half = vdupq_n_f32(0.5f);
+			const float32x4_t sqrt2 = vdupq_n_f32(NoiseKernels::POWER_SQRT2);
+			const float32x4_t exponent = vdupq_n_f32(p_exponent.value);
+			const float32x4_t zero = vdupq_n_f32(0.f);
+			const float32x4_t lowest = vdupq_n_f32(-127.f);
+			const float32x4_t highest = vdupq_n_f32(128.f);
+			const float32x4_t underflow = vdupq_n_f32(-126.f);
+			const float32x4_t normal = vdupq_n_f32(std::numeric_limits<float>::min());
+			const float32x4_t nan = vdupq_n_f32(std::numeric_limits<float>::quiet_NaN());
+			const float32x4_t overflow = vdupq_n_f32(infinity);
+			const float32x4_t of_zero = vdupq_n_f32(p_exponent.value > 0.f ? 0.f : infinity);
+			const float32x4_t of_infinity = vdupq_n_f32(p_exponent.value > 0.f ? infinity : 0.f);
+			const int32x4_t bias = vdupq_n_s32(127);
+			for (; i + 4 <= p_count; i += 4) {
+				const float32x4_t base = vld1q_f32(p_a + i);
+				const uint32x4_t bits = vreinterpretq_u32_f32(base);
+				int32x4_t whole_exponent = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), bias);
+				float32x4_t mantissa = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f800000)));
+				const uint32x4_t high = vcgtq_f32(mantissa, sqrt2);
+				mantissa = vbslq_f32(high, vmulq_f32(mantissa, half), mantissa);
+				whole_exponent = vsubq_s32(whole_exponent, vreinterpretq_s32_u32(high));
+				const float32x4_t t = vdivq_f32(vsubq_f32(mantissa, one), vaddq_f32(mantissa, one));
+				const float32x4_t t2 = vmulq_f32(t, t);
+				float32x4_t log2 = vaddq_f32(vdupq_n_f32(NoiseKernels::POWER_LOG2[2]), vmulq_f32(t2, vdupq_n_f32(NoiseKernels::POWER_LOG2[3])));
+				log2 = vaddq_f32(vdupq_n_f32(NoiseKernels::POWER_LOG2[1]), vmulq_f32(t2, log2));
+				log2 = vaddq_f32(vdupq_n_f32(NoiseKernels::POWER_LOG2[0]), vmulq_f32(t2, log2));
+				log2 = vaddq_f32(vcvtq_f32_s32(whole_exponent), vmulq_f32(t, log2));
+
+				float32x4_t y = vmulq_f32(exponent, log2);
+				y = vbslq_f32(vcgtq_f32(y, lowest), y, lowest);
+				y = vbslq_f32(vcltq_f32(y, highest), y, highest);
+				int32x4_t whole = vcvtq_s32_f32(y);
+				whole = vaddq_s32(whole, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(whole), y)));
+				const float32x4_t f = vsubq_f32(y, vcvtq_f32_s32(whole));
+				float32x4_t fraction = vdupq_n_f32(NoiseKernels::POWER_EXP2[8]);
+				for (int j = 7; j >= 0; --j) {
+					fraction = vaddq_f32(vdupq_n_f32(NoiseKernels::POWER_EXP2[j]), vmulq_f32(f, fraction));
+				}
+				fraction = vaddq_f32(one, vmulq_f32(f, fraction));
+				const float32x4_t scale = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(whole, bias), 23));
+
+				float32x4_t result = vmulq_f32(fraction, scale);
+				result = vbslq_f32(vcgeq_f32(y, highest), overflow, result);
+				result = vbslq_f32(vcltq_f32(y, underflow), zero, result);
+				result = vbslq_f32(vcltq_f32(base, normal), of_zero, result);
+				result = vbslq_f32(vcltq_f32(base, zero), nan, result);
+				result = vbslq_f32(vceqq_f32(base, overflow), of_infinity, result);
+				result = vbslq_f32(vceqq_f32(base, base), result, base);
+				vst1q_f32(r_values + i, result);
+			}
+		} break;
+		default:
+			break;
+	}
+	NoiseKernels::Scalar::power(p_a + i, r_values + i, p_count - i, p_exponent);
+}
+
+static void _neon_lookup(const real_t *p_a, real_t *r_values, int p_count, const real_t *p_table, int p_size) {
+	const float32x4_t one = vdupq_n_f32(1.f);
+	const float32x4_t zero = vdupq_n_f32(0.f);
+	const float32x4_t scale = vdupq_n_f32(0.5f * p_size);
+	const float32x4_t size = vdupq_n_f32(p_size);
+	const int32x4_t last = vdupq_n_s32(p_size - 1);
+	int32_t indices[4];
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		float32x4_t position = vmulq_f32(vaddq_f32(vld1q_f32(p_a + i), one), scale);
+		position = vbslq_f32(vcgtq_f32(position, zero), position, zero);
+		position = vbslq_f32(vcltq_f32(position, size), position, size);
+		int32x4_t index = vminq_s32(vcvtq_s32_f32(position), last);
+		float32x4_t fraction = vsubq_f32(position, vcvtq_f32_s32(index));
+		vst1q_s32(indices, index);
+		const float low_lanes[4] = { p_table[indices[0]], p_table[indices[1]], p_table[indices[2]], p_table[indices[3]] };
+		const float high_lanes[4] = { p_table[indices[0] + 1], p_table[indices[1] + 1], p_table[indices[2] + 1], p_table[indices[3] + 1] };
+		float32x4_t low = vld1q_f32(low_lanes);
+		vst1q_f32(r_values + i, vaddq_f32(low, vmulq_f32(fraction, vsubq_f32(vld1q_f32(high_lanes), low))));
+	}
+	NoiseKernels::Scalar::lookup(p_a + i, r_values + i, p_count - i, p_table, p_size);
+}
+
+#endif // NOISE_KERNELS_NEON
+
+// Dispatch
+
+struct NoiseKernelTable {
+	NoiseKernels::InstructionSet instruction_set{ NoiseKernels::INSTRUCTION_SET_SCALAR };
+	void (*add)(const real_t *, const real_t *, real_t *, int){ NoiseKernels::Scalar::add };
+	void (*multiply)(const real_t *, const real_t *, real_t *, int){ NoiseKernels::Scalar::multiply };
+	void (*max)(const real_t *, const real_t *, real_t *, int){ NoiseKernels::Scalar::max };
+	void (*min)(const real_t *, const real_t *, real_t *, int){ NoiseKernels::Scalar::min };
+	void (*absolute)(const real_t *, real_t *, int){ NoiseKernels::Scalar::absolute };
+	void (*invert)(const real_t *, real_t *, int){ NoiseKernels::Scalar::invert };
+	void (*clamp)(const real_t *, real_t *, int, real_t, real_t, real_t){ NoiseKernels::Scalar::clamp };
+	void (*affine)(const real_t *, real_t *, int, real_t, real_t){ NoiseKernels::Scalar::affine };
+	void (*mix)(const real_t *, const real_t *, const real_t *, real_t *, int){ NoiseKernels::Scalar::mix };
+	void (*select)(const real_t *, const real_t *, const real_t *, real_t *, int, real_t){ NoiseKernels::Scalar::select };
+	void (*power)(const real_t *, real_t *, int, const NoiseKernels::Exponent &){ NoiseKernels::Scalar::power };
+	void (*lookup)(const real_t *, real_t *, int, const real_t *, int){ NoiseKernels::Scalar::lookup };
+};
+
+#define NOISE_KERNEL_TABLE_FILL(m_table, m_set, m_prefix) \
+	m_table.instruction_set = m_set;                      \
+	m_table.add = m_prefix##_add;                         \
+	m_table.multiply = m_prefix##_multiply;               \
+	m_table.max = m_prefix##_max;                         \
+	m_table.min = m_prefix##_min;                         \
+	m_table.absolute = m_prefix##_absolute;               \
+	m_table.invert = m_prefix##_invert;                   \
+	m_table.clamp = m_prefix##_clamp;                     \
+	m_table.affine = m_prefix##_affine;                   \
+	m_table.mix = m_prefix##_mix;                         \
+	m_table.select = m_prefix##_select;                   \
+	m_table.power = m_prefix##_power;                     \
+	m_table.lookup = m_prefix##_lookup;
+
+static NoiseKernelTable _detect_kernels() {
+	NoiseKernelTable table;
+#if defined(NOISE_KERNELS_X86)
+	if (_cpu_has_avx2()) {
+		NOISE_KERNEL_TABLE_FILL(table, NoiseKernels::INSTRUCTION_SET_AVX2, _avx2)
+	} else if (_cpu_has_sse2()) {
+		NOISE_KERNEL_TABLE_FILL(table, NoiseKernels::INSTRUCTION_SET_SSE2, _sse2)
+	}
+#elif defined(NOISE_KERNELS_NEON)
+	NOISE_KERNEL_TABLE_FILL(table, NoiseKernels::INSTRUCTION_SET_NEON, _neon)
+#endif
+	return table;
+}
+
+static const NoiseKernelTable &_get_kernels() {
+	static const NoiseKernelTable table = _detect_kernels();
+	return table;
+}
+
+NoiseKernels::Exponent NoiseKernels::Exponent::make(real_t p_value, bool p_approximate) {
+	Exponent exponent;
+	exponent.value = p_value;
+	if (p_value == Math::floor(p_value)) {
+		// Larger integers still need std::pow for negative bases.
+		if (Math::abs(p_value) <= MAX_INTEGER_EXPONENT) {
+			exponent.mode = MODE_INTEGER;
+			exponent.integer = int(p_value);
+		}
+	} else if (p_value == 0.5) {
+		exponent.mode = MODE_SQRT;
+#if !defined(REAL_T_IS_DOUBLE)
+	} else if (p_approximate && std::isfinite(p_value)) {
+		exponent.mode = MODE_APPROXIMATE;
+#endif
+	}
+	return exponent;
+}
+
+NoiseKernels::InstructionSet NoiseKernels::get_instruction_set() {
+	return _get_kernels().instruction_set;
+}
+
+const char *NoiseKernels::get_instruction_set_name() {
+	switch (get_instruction_set()) {
+		case INSTRUCTION_SET_SSE2:
+			return "SSE2";
+		case INSTRUCTION_SET_AVX2:
+			return "AVX2";
+		case INSTRUCTION_SET_NEON:
+			return "NEON";
+		default:
+			return "Scalar";
+	}
+}
+
+void NoiseKernels::add(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	_get_kernels().add(p_a, p_b, r_values, p_count);
+}
+
+void NoiseKernels::multiply(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	_get_kernels().multiply(p_a, p_b, r_values, p_count);
+}
+
+void NoiseKernels::max(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	_get_kernels().max(p_a, p_b, r_values, p_count);
+}
+
+void NoiseKernels::min(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count) {
+	_get_kernels().min(p_a, p_b, r_values, p_count);
+}
+
+void NoiseKernels::absolute(const real_t *p_a, real_t *r_values, int p_count) {
+	_get_kernels().absolute(p_a, r_values, p_count);
+}
+
+void NoiseKernels::invert(const real_t *p_a, real_t *r_values, int p_count) {
+	_get_kernels().invert(p_a, r_values, p_count);
+}
+
+void NoiseKernels::clamp(const real_t *p_a, real_t *r_values, int p_count, real_t p_lower, real_t p_upper, real_t p_interval) {
+	_get_kernels().clamp(p_a, r_values, p_count, p_lower, p_upper, p_interval);
+}
+
+void NoiseKernels::affine(const real_t *p_a, real_t *r_values, int p_count, real_t p_scale, real_t p_bias) {
+	_get_kernels().affine(p_a, r_values, p_count, p_scale, p_bias);
+}
+
+void NoiseKernels::mix(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count) {
+	_get_kernels().mix(p_first, p_second, p_selector, r_values, p_count);
+}
+
+void NoiseKernels::select(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count, real_t p_threshold) {
+	_get_kernels().select(p_first, p_second, p_selector, r_values, p_count, p_threshold);
+}
+
+void NoiseKernels::power(const real_t *p_a, real_t *r_values, int p_count, const Exponent &p_exponent) {
+	_get_kernels().power(p_a, r_values, p_count, p_exponent);
+}
+
+void NoiseKernels::lookup(const real_t *p_a, real_t *r_values, int p_count, const real_t *p_table, int p_size) {
+	_get_kernels().lookup(p_a, r_values, p_count, p_table, p_size);
+}
@@ -0,0 +1,210 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_KERNELS_H
+#define NOISE_KERNELS_H
+
+#include "core/math/math_funcs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Element-wise kernels applied by operators over operand buffers.
+// The best instruction set available is picked once at runtime. Every implementation gives the same
+// values as the scalar functions below, which are also the ones used when sampling point by point, bit
+// for bit except for the sign and payload of NaNs.
+class NoiseKernels {
+public:
+	enum InstructionSet {
+		INSTRUCTION_SET_SCALAR,
+		INSTRUCTION_SET_SSE2,
+		INSTRUCTION_SET_AVX2,
+		INSTRUCTION_SET_NEON,
+	};
+
+	static InstructionSet get_instruction_set();
+	static const char *get_instruction_set_name();
+
+	// Exponent known before the evaluation, with the fastest way to raise values to it.
+	struct Exponent {
+		static constexpr int MAX_INTEGER_EXPONENT = 16;
+
+		enum Mode {
+			// std::pow.
+			MODE_GENERIC,
+			// Integer exponent, within MAX_INTEGER_EXPONENT, by repeated squaring. Within |exponent| units in the
+			// last place.
+			MODE_INTEGER,
+			// Exponent of 0.5, by a square root. Unlike std::pow, -0 stays -0 and -inf gives a NaN.
+			MODE_SQRT,
+			// Any other exponent, through approximations of log2 and exp2. See approximate_power().
+			MODE_APPROXIMATE,
+		};
+
+		Mode mode{ MODE_GENERIC };
+		real_t value{ 1. };
+		int integer{ 1 };
+
+		// The approximation is only picked in single precision builds.
+		static Exponent make(real_t p_value, bool p_approximate = true);
+	};
+
+	static real_t clamp(real_t p_value, real_t p_lower, real_t p_upper, real_t p_interval) {
+		real_t clamped = std::clamp(p_value, p_lower, p_upper);
+		return (p_interval != 0.) ? (clamped - p_lower) / p_interval : clamped;
+	}
+
+	static real_t mix(real_t p_first, real_t p_second, real_t p_selector) {
+		real_t ratio = (p_selector + 1.) / 2.;
+		return (ratio * p_second) + ((1. - ratio) * p_first);
+	}
+
+	static real_t select(real_t p_first, real_t p_second, real_t p_selector, real_t p_threshold) {
+		return (p_selector < p_threshold) ? p_first : p_second;
+	}
+
+	static real_t power(real_t p_base, const Exponent &p_exponent) {
+		switch (p_exponent.mode) {
+			case Exponent::MODE_INTEGER:
+				return integer_power(p_base, p_exponent.integer);
+			case Exponent::MODE_SQRT:
+				return std::sqrt(p_base);
+			case Exponent::MODE_APPROXIMATE:
+				return approximate_power(p_base, p_exponent.value);
+			default:
+				return std::pow(p_base, p_exponent.value);
+		}
+	}
+
+	static real_t integer_power(real_t p_base, int p_exponent) {
+		real_t result = 1.;
+		real_t square = p_base;
+		for (int n = std::abs(p_exponent); n != 0;) {
+			if (n & 1) {
+				result *= square;
+			}
+			n >>= 1;
+			if (n != 0) {
+				square *= square;
+			}
+		}
+		return p_exponent < 0 ? real_t(1.) / result : result;
+	}
+
+	// Relative error bound of approximate_power(), to be scaled by 1 + |exponent * log2(base)|.
+	static constexpr real_t APPROXIMATE_POWER_ERROR = 3e-7;
+
+	// 2 ^ (exponent * log2(base)), with log2 and exp2 given by polynomials after splitting the exponent and
+	// mantissa of the floats. The relative error stays below 3e-7 * (1 + |exponent * log2(base)|), so within
+	// a few units in the last place for the usual exponents and bases. Bases below the smallest normal float
+	// count as zeros, and so do results, instead of subnormals. Negative bases give NaNs, as with std::pow and
+	// a non-integer exponent.
+	static float approximate_power(float p_base, float p_exponent) {
+		uint32_t bits;
+		std::memcpy(&bits, &p_base, sizeof(bits));
+		// base = mantissa * 2 ^ exponent, with the mantissa in [sqrt(1/2), sqrt(2)).
+		int32_t exponent = int32_t(bits >> 23) - 127;
+		const uint32_t mantissa_bits = (bits & 0x007fffffu) | 0x3f800000u;
+		float mantissa;
+		std::memcpy(&mantissa, &mantissa_bits, sizeof(mantissa));
+		const bool high = mantissa > POWER_SQRT2;
+		mantissa = high ? mantissa * 0.5f : mantissa;
+		exponent += high ? 1 : 0;
+		// log2(m) = 2 atanh(t) / ln(2), with t = (m - 1) / (m + 1) in [-0.172, 0.172].
+		const float t = (mantissa - 1.f) / (mantissa + 1.f);
+		const float t2 = t * t;
+		const float log2 = float(exponent) + (t * (POWER_LOG2[0] + (t2 * (POWER_LOG2[1] + (t2 * (POWER_LOG2[2] + (t2 * POWER_LOG2[3])))))));
+
+		// 2 ^ y = 2 ^ i * 2 ^ f, with i the floor of y. Exact when y is an integer, 1 ^ exponent included.
+		const float y = std::min(128.f, std::max(-127.f, p_exponent * log2));
+		int32_t whole = int32_t(y);
+		whole -= (float(whole) > y) ? 1 : 0;
+		const float f = y - float(whole);
+		float fraction = POWER_EXP2[8];
+		for (int i = 7; i >= 0; --i) {
+			fraction = POWER_EXP2[i] + (f * fraction);
+		}
+		fraction = 1.f + (f * fraction);
+		const uint32_t scale_bits = uint32_t(whole + 127) << 23;
+		float scale;
+		std::memcpy(&scale, &scale_bits, sizeof(scale));
+
+		const float infinity = std::numeric_limits<float>::infinity();
+		float result = fraction * scale;
+		result = (y >= 128.f) ? infinity : result;
+		result = (y < -126.f) ? 0.f : result;
+		result = (p_base < std::numeric_limits<float>::min()) ? (p_exponent > 0.f ? 0.f : infinity) : result;
+		result = (p_base < 0.f) ? std::numeric_limits<float>::quiet_NaN() : result;
+		result = (p_base == infinity) ? (p_exponent > 0.f ? infinity : 0.f) : result;
+		result = (p_base != p_base) ? p_base : result;
+		return result;
+	}
+
+	// Linear interpolation in a table of p_size + 1 samples spread evenly over [-1, 1], clamped at both ends.
+	// NaNs read the first sample.
+	static real_t lookup(real_t p_value, const real_t *p_table, int p_size) {
+		const real_t position = std::min(real_t(p_size), std::max(real_t(0.), (p_value + real_t(1.)) * (real_t(0.5) * p_size)));
+		const int index = std::min(int(position), p_size - 1);
+		const real_t fraction = position - real_t(index);
+		return p_table[index] + (fraction * (p_table[index + 1] - p_table[index]));
+	}
+
+	static void add(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+	static void multiply(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+	static void max(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+	static void min(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+	static void absolute(const real_t *p_a, real_t *r_values, int p_count);
+	static void invert(const real_t *p_a, real_t *r_values, int p_count);
+	// A null interval disables the normalization.
+	static void clamp(const real_t *p_a, real_t *r_values, int p_count, real_t p_lower, real_t p_upper, real_t p_interval);
+	static void affine(const real_t *p_a, real_t *r_values, int p_count, real_t p_scale, real_t p_bias);
+	static void mix(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count);
+	static void select(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count, real_t p_threshold);
+	static void power(const real_t *p_a, real_t *r_values, int p_count, const Exponent &p_exponent);
+	static void lookup(const real_t *p_a, real_t *r_values, int p_count, const real_t *p_table, int p_size);
+
+	// Reference implementations, whatever the instruction set.
+	struct Scalar {
+		static void add(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+		static void multiply(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+		static void max(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+		static void min(const real_t *p_a, const real_t *p_b, real_t *r_values, int p_count);
+		static void absolute(const real_t *p_a, real_t *r_values, int p_count);
+		static void invert(const real_t *p_a, real_t *r_values, int p_count);
+		static void clamp(const real_t *p_a, real_t *r_values, int p_count, real_t p_lower, real_t p_upper, real_t p_interval);
+		static void affine(const real_t *p_a, real_t *r_values, int p_count, real_t p_scale, real_t p_bias);
+		static void mix(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count);
+		static void select(const real_t *p_first, const real_t *p_second, const real_t *p_selector, real_t *r_values, int p_count, real_t p_threshold);
+		static void power(const real_t *p_a, real_t *r_values, int p_count, const Exponent &p_exponent);
+		static void lookup(const real_t *p_a, real_t *r_values, int p_count, const real_t *p_table, int p_size);
+	};
+
+	// Coefficients of approximate_power().
+	static constexpr float POWER_SQRT2 = 1.41421356237309505f;
+	static constexpr float POWER_LOG2[4] = { 2.88539008177792681f, 0.96179669392597560f, 0.57707801635558536f, 0.41219858311113240f };
+	static constexpr float POWER_EXP2[9] = { 0.69314718055994529f, 0.24022650695910069f, 0.05550410866482158f, 0.00961812910762848f, 0.00133335581464284f, 0.00015403530393382f, 0.00001525273380406f, 0.00000132154867901f, 0.00000010178086009f };
+};
+
+#endif
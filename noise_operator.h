@@ -24,21 +24,24 @@
 #ifndef NOISE_OPERATOR_H
 #define NOISE_OPERATOR_H
 
+#include <array>
 #include <cstddef>
-#include <functional>
 
+#include "core/variant/typed_array.h"
 #include "noise_base.h"
+#include "noise_program.h"
+#include "noise_sync.h"
 
 template <std::size_t N>
 class NaryNoiseOperator : public NoiseNode {
 private:
 	std::array<Ref<Noise>, N> operands;
-	std::function<real_t(const std::array<real_t, N> &)> function;
 
 public:
-	explicit NaryNoiseOperator(std::function<real_t(const std::array<real_t, N> &)> f) :
-			NoiseNode(N),
-			function(f) {
+	static constexpr std::size_t OPERAND_COUNT = N;
+
+	NaryNoiseOperator() :
+			NoiseNode(N) {
 	}
 
 	virtual ~NaryNoiseOperator() {
@@ -55,12 +58,120 @@ public:
 
 	size_t get_operator_count() const { return N; }
 
-	real_t get_noise_1d(real_t p_x) const override {
-		std::array<real_t, N> result;
-		for (size_t i = 0; i < N; ++i) {
-			result[i] = operands[i].is_valid() ? operands[i]->get_noise_1d(p_x) : 0.;
+protected:
+	void _changed() {
+		_update_cache();
+		_notify_changed();
+	}
+
+	// Called whenever the operator or one of its operands changed, before the change is notified.
+	virtual void _update_cache() {}
+
+	void set_operand(Ref<Noise> n, size_t index) {
+		ERR_FAIL_COND_MSG(index < 0 || index >= N, "Invalid operand index");
+		if (operands[index].is_valid()) {
+			operands[index]->disconnect_changed(callable_mp(this, &NaryNoiseOperator<N>::_changed));
+		}
+		operands[index] = n;
+		if (operands[index].is_valid()) {
+			operands[index]->connect_changed(callable_mp(this, &NaryNoiseOperator<N>::_changed));
+		}
+		_changed();
+	}
+
+	Ref<Noise> get_operand(size_t index) const {
+		return operands[index];
+	}
+
+	real_t sample_operand(size_t index, real_t p_x) const {
+		return operands[index].is_valid() ? operands[index]->get_noise_1d(p_x) : 0.;
+	}
+
+	real_t sample_operand(size_t index, real_t p_x, real_t p_y) const {
+		return operands[index].is_valid() ? operands[index]->get_noise_2d(p_x, p_y) : 0.;
+	}
+
+	real_t sample_operand(size_t index, real_t p_x, real_t p_y, real_t p_z) const {
+		return operands[index].is_valid() ? operands[index]->get_noise_3d(p_x, p_y, p_z) : 0.;
+	}
+
+	real_t sample_operand(size_t index, const Vector2 &p_v) const {
+		return sample_operand(index, p_v.x, p_v.y);
+	}
+
+	real_t sample_operand(size_t index, const Vector3 &p_v) const {
+		return sample_operand(index, p_v.x, p_v.y, p_v.z);
+	}
+
+	// Value of an operand, and its gradient when r_gradient is set.
+	template <typename P>
+	real_t sample_operand_gradient(size_t index, const P &p_point, P *r_gradient) const {
+		if (r_gradient) {
+			return get_gradient(operands[index], p_point, *r_gradient);
+		}
+		return sample_operand(index, p_point);
+	}
+
+	template <typename P>
+	void sample_operand_batch(size_t index, const P *p_points, real_t *r_values, int p_count) const {
+		sample_batch(operands[index], p_points, r_values, p_count);
+	}
+
+	// Samples an operand on some lanes of a block only. Other lanes of r_values are left untouched.
+	template <typename P>
+	void sample_operand_lanes(size_t index, const P *p_points, const int *p_lanes, int p_lane_count, int p_count, real_t *r_values) const {
+		if (p_lane_count == p_count) {
+			sample_batch(operands[index], p_points, r_values, p_count);
+			return;
 		}
-		return function(result);
+		if (p_lane_count == 0) {
+			return;
+		}
+		P points[BATCH_SIZE];
+		real_t values[BATCH_SIZE];
+		for (int i = 0; i < p_lane_count; ++i) {
+			points[i] = p_points[p_lanes[i]];
+		}
+		sample_batch(operands[index], points, values, p_lane_count);
+		for (int i = 0; i < p_lane_count; ++i) {
+			r_values[p_lanes[i]] = values[i];
+		}
+	}
+
+	int emit_operator(NoiseProgram &p_program, NoiseProgram::OpCode p_op, std::array<real_t, 3> p_params = {}, const Ref<Noise> &p_node = Ref<Noise>()) const {
+		static_assert(N <= 3, "Instructions have at most 3 operands");
+		NoiseProgram::Instruction instruction;
+		instruction.op = p_op;
+		instruction.param = p_params;
+		// Selectors come first, so that the program knows which branches a block needs before reaching them.
+		const bool selected = N == 3 && (p_op == NoiseProgram::OP_MIX || p_op == NoiseProgram::OP_SELECT);
+		if (selected) {
+			instruction.src[N - 1] = p_program.compile(operands[N - 1]);
+		}
+		for (size_t i = 0; i < (selected ? N - 1 : N); ++i) {
+			instruction.src[i] = p_program.compile(operands[i]);
+		}
+		return p_program.emit(instruction, p_node);
+	}
+};
+
+// Evaluation loops of an operator whose function is known at compile time.
+// Derived provides `real_t compute(const std::array<real_t, N> &) const`, inlined in every loop below,
+// and `NoiseInterval compute_interval(const std::array<NoiseInterval, N> &) const` giving its bounds.
+// It may also provide its own `compute_batch` working on whole operand buffers, and `prune_operands`
+// telling which operand alone gives its value when the operands stay within strict bounds.
+// Gradients use `compute_partials`, which Derived should provide too: the default one takes central
+// differences of `compute`, two more evaluations per operand, and is only as exact as their step.
+// Operators that do not always need all of their operands replace `evaluate`, which gets a sampler of
+// operands for one point, and `evaluate_block`, which gets the points of a block of at most BATCH_SIZE.
+template <typename Derived, typename Base>
+class NoiseOperatorKernel : public Base {
+	static constexpr std::size_t N = Base::OPERAND_COUNT;
+
+public:
+	real_t get_noise_1d(real_t p_x) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _derived().evaluate([&](size_t i) { return this->sample_operand(i, p_x); });
 	}
 
 	real_t get_noise_2dv(Vector2 p_v) const override {
@@ -68,11 +179,8 @@ public:
 	}
 
 	real_t get_noise_2d(real_t p_x, real_t p_y) const override {
-		std::array<real_t, N> result;
-		for (size_t i = 0; i < N; ++i) {
-			result[i] = operands[i].is_valid() ? operands[i]->get_noise_2d(p_x, p_y) : 0.;
-		}
-		return function(result);
+		NOISE_PROFILE_SCOPE(1);
+		return _derived().evaluate([&](size_t i) { return this->sample_operand(i, p_x, p_y); });
 	}
 
 	real_t get_noise_3dv(Vector3 p_v) const override {
@@ -80,33 +188,437 @@ public:
 	}
 
 	real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _derived().evaluate([&](size_t i) { return this->sample_operand(i, p_x, p_y, p_z); });
+	}
+
+	void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const override {
+		_get_noise_batch(p_x, r_values, p_count);
+	}
+
+	void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override {
+		_get_noise_batch(p_v, r_values, p_count);
+	}
+
+	void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override {
+		_get_noise_batch(p_v, r_values, p_count);
+	}
+
+	real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _derived().evaluate_gradient([&](size_t i, Vector2 *r_operand_gradient) { return this->sample_operand_gradient(i, p_v, r_operand_gradient); }, r_gradient);
+	}
+
+	real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _derived().evaluate_gradient([&](size_t i, Vector3 *r_operand_gradient) { return this->sample_operand_gradient(i, p_v, r_operand_gradient); }, r_gradient);
+	}
+
+	NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override {
+		return _derived().compute_interval(_get_operand_intervals(p_region, p_strict));
+	}
+
+	int prune(const NoiseRegion &p_region, real_t &r_value) const override {
+		const NoiseInterval result = this->get_region_interval(p_region, true);
+		if (result.lower == result.upper) {
+			r_value = result.lower;
+			return NoiseNode::PRUNE_CONSTANT;
+		}
+		return _derived().prune_operands(_get_operand_intervals(p_region, true));
+	}
+
+	int prune_operands(const std::array<NoiseInterval, N> &p_intervals) const {
+		return NoiseNode::PRUNE_NONE;
+	}
+
+	template <typename S>
+	real_t evaluate(const S &p_sample) const {
+		return _evaluate_operands(p_sample);
+	}
+
+	template <typename P>
+	void evaluate_block(const P *p_points, real_t *r_values, int p_count) const {
+		_evaluate_operands_block(p_points, r_values, p_count);
+	}
+
+	// Value and gradient, from the values and gradients of every operand by the chain rule.
+	template <typename S, typename G>
+	real_t evaluate_gradient(const S &p_sample, G &r_gradient) const {
+		std::array<real_t, N> values;
+		std::array<G, N> gradients;
+		for (size_t i = 0; i < N; ++i) {
+			values[i] = p_sample(i, &gradients[i]);
+		}
+		const std::array<real_t, N> partials = _derived().compute_partials(values);
+		r_gradient = G();
+		for (size_t i = 0; i < N; ++i) {
+			r_gradient += gradients[i] * partials[i];
+		}
+		return _derived().compute(values);
+	}
+
+	// Partial derivatives of the function with respect to each operand, by central differences unless known.
+	std::array<real_t, N> compute_partials(const std::array<real_t, N> &p_args) const {
+		std::array<real_t, N> partials;
+		std::array<real_t, N> shifted = p_args;
+		for (size_t i = 0; i < N; ++i) {
+			const real_t step = NoiseNode::GRADIENT_STEP * MAX(1., Math::abs(p_args[i]));
+			shifted[i] = p_args[i] + step;
+			const real_t up = _derived().compute(shifted);
+			shifted[i] = p_args[i] - step;
+			const real_t down = _derived().compute(shifted);
+			shifted[i] = p_args[i];
+			partials[i] = (up - down) / (2. * step);
+		}
+		return partials;
+	}
+
+	void compute_batch(const std::array<const real_t *, N> &p_args, real_t *r_values, int p_count) const {
+		std::array<real_t, N> args;
+		for (int j = 0; j < p_count; ++j) {
+			for (size_t i = 0; i < N; ++i) {
+				args[i] = p_args[i][j];
+			}
+			r_values[j] = _derived().compute(args);
+		}
+	}
+
+protected:
+	const Derived &_derived() const { return *static_cast<const Derived *>(this); }
+
+	std::array<NoiseInterval, N> _get_operand_intervals(const NoiseRegion &p_region, bool p_strict) const {
+		std::array<NoiseInterval, N> intervals;
+		for (size_t i = 0; i < N; ++i) {
+			intervals[i] = NoiseNode::get_interval(this->get_operand(i), p_region, p_strict);
+		}
+		return intervals;
+	}
+
+	// Evaluation of every operand, then of the function.
+	template <typename S>
+	real_t _evaluate_operands(const S &p_sample) const {
 		std::array<real_t, N> result;
 		for (size_t i = 0; i < N; ++i) {
-			result[i] = operands[i].is_valid() ? operands[i]->get_noise_3d(p_x, p_y, p_z) : 0.;
+			result[i] = p_sample(i);
+		}
+		return _derived().compute(result);
+	}
+
+	// Operands are evaluated over a whole block before the function is applied over the buffers.
+	template <typename P>
+	void _evaluate_operands_block(const P *p_points, real_t *r_values, int p_count) const {
+		std::array<std::array<real_t, NoiseNode::BATCH_SIZE>, N> buffer;
+		std::array<const real_t *, N> args;
+		for (size_t i = 0; i < N; ++i) {
+			this->sample_operand_batch(i, p_points, buffer[i].data(), p_count);
+			args[i] = buffer[i].data();
 		}
-		return function(result);
+		_derived().compute_batch(args, r_values, p_count);
 	}
 
+private:
+	template <typename P>
+	void _get_noise_batch(const P *p_points, real_t *r_values, int p_count) const {
+		NOISE_PROFILE_SCOPE(p_count);
+		for (int offset = 0; offset < p_count; offset += NoiseNode::BATCH_SIZE) {
+			_derived().evaluate_block(p_points + offset, r_values + offset, MIN(NoiseNode::BATCH_SIZE, p_count - offset));
+		}
+	}
+};
+
+// Operator over any number of operands, stored as a single array property. Null operands are sampled as zero.
+class NoiseArrayOperator : public NoiseNode {
+	GDCLASS(NoiseArrayOperator, NoiseNode);
+
+public:
+	NoiseArrayOperator() :
+			NoiseNode(0) {}
+	virtual ~NoiseArrayOperator();
+
+	void set_noises(const TypedArray<Noise> &p_noises);
+	TypedArray<Noise> get_noises() const;
+
+	virtual Ref<Noise> get_child(int n) const override;
+
 protected:
+	// Operands with their weights, as read by the sampling threads.
+	struct Operands {
+		LocalVector<Ref<Noise>> noises;
+		LocalVector<real_t> weights;
+	};
+
 	void _changed() {
-		emit_changed();
+		_update_cache();
+		_notify_changed();
 	}
 
-	void set_operand(Ref<Noise> n, size_t index) {
-		ERR_FAIL_COND_MSG(index < 0 || index >= N, "Invalid operand index");
-		if (operands[index].is_valid()) {
-			operands[index]->disconnect_changed(callable_mp(this, &NaryNoiseOperator<N>::_changed));
+	// Called whenever the operator or one of its operands changed, before the change is notified. Publishes
+	// the operands, so must be called by overrides.
+	virtual void _update_cache();
+
+	// Weight the value of an operand is scaled by.
+	virtual real_t _get_weight(uint32_t p_index) const { return 1.; }
+
+	NoiseDoubleBuffer<Operands>::Reader _read_operands() const { return published.read(); }
+
+	static void _bind_methods();
+
+private:
+	LocalVector<Ref<Noise>> noises;
+	// Published on every change, so that the operands can change while being sampled.
+	NoiseDoubleBuffer<Operands> published;
+};
+
+// Evaluation loops of an operator folding its operands, from the first to the last, with a function known at
+// compile time. Every operand is sampled in one flat loop, or over a whole block before being folded into the
+// result buffer. Derived provides:
+// - `real_t combine(real_t, real_t)` and `void combine_batch(const real_t *, const real_t *, real_t *, int)`,
+// - `real_t combine_gradient(real_t, G &, real_t, const G &)`, folding the gradients too,
+// - `NoiseInterval combine_interval(const NoiseInterval &, const NoiseInterval &)` giving its bounds,
+// - `bool dominates(const NoiseInterval &, const NoiseInterval &)` telling whether an operand within the first
+//   bounds alone gives the result whatever the value of another one within the second bounds,
+// - `OPCODE`, the binary instruction the fold is compiled into.
+// It may also provide `is_absorbing(real_t)`, telling that the remaining operands need not be sampled. The
+// result then stays as it is even where they are infinite or NaN, and so does the compiled instruction when it
+// treats its second operand the same way, as OP_MULTIPLY does with zeros.
+template <typename Derived>
+class NoiseArrayKernel : public NoiseArrayOperator {
+public:
+	static bool is_absorbing(real_t p_value) { return false; }
+
+	real_t get_noise_1d(real_t p_x) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _evaluate(p_x);
+	}
+
+	real_t get_noise_2dv(Vector2 p_v) const override {
+		return get_noise_2d(p_v.x, p_v.y);
+	}
+
+	real_t get_noise_2d(real_t p_x, real_t p_y) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _evaluate(Vector2(p_x, p_y));
+	}
+
+	real_t get_noise_3dv(Vector3 p_v) const override {
+		return get_noise_3d(p_v.x, p_v.y, p_v.z);
+	}
+
+	real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _evaluate(Vector3(p_x, p_y, p_z));
+	}
+
+	void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const override {
+		_get_noise_batch(p_x, r_values, p_count);
+	}
+
+	void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override {
+		_get_noise_batch(p_v, r_values, p_count);
+	}
+
+	void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override {
+		_get_noise_batch(p_v, r_values, p_count);
+	}
+
+	real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _evaluate_gradient(p_v, r_gradient);
+	}
+
+	real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const override {
+		NOISE_PROFILE_SCOPE(1);
+		return _evaluate_gradient(p_v, r_gradient);
+	}
+
+	NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override {
+		const NoiseDoubleBuffer<Operands>::Reader operands = _read_operands();
+		if (operands->noises.is_empty()) {
+			return NoiseInterval::point(0.);
 		}
-		operands[index] = n;
-		if (operands[index].is_valid()) {
-			operands[index]->connect_changed(callable_mp(this, &NaryNoiseOperator<N>::_changed));
+		NoiseInterval result = _get_operand_interval(*operands, 0, p_region, p_strict);
+		for (uint32_t i = 1; i < operands->noises.size(); ++i) {
+			result = Derived::combine_interval(result, _get_operand_interval(*operands, i, p_region, p_strict));
 		}
-		emit_changed();
+		return result;
 	}
 
-	Ref<Noise> get_operand(size_t index) const {
-		return operands[index];
+	int prune(const NoiseRegion &p_region, real_t &r_value) const override {
+		const NoiseInterval result = get_region_interval(p_region, true);
+		if (result.lower == result.upper) {
+			r_value = result.lower;
+			return NoiseNode::PRUNE_CONSTANT;
+		}
+		const NoiseDoubleBuffer<Operands>::Reader operands = _read_operands();
+		const uint32_t count = operands->noises.size();
+		LocalVector<NoiseInterval> intervals;
+		intervals.resize(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			intervals[i] = _get_operand_interval(*operands, i, p_region, true);
+		}
+		for (uint32_t i = 0; i < count; ++i) {
+			if (operands->weights[i] != 1.) {
+				continue;
+			}
+			bool alone = true;
+			for (uint32_t j = 0; j < count && alone; ++j) {
+				alone = i == j || Derived::dominates(intervals[i], intervals[j]);
+			}
+			if (alone) {
+				return i;
+			}
+		}
+		return NoiseNode::PRUNE_NONE;
+	}
+
+	// Binary instructions folding the operands in the same order as the evaluation.
+	int emit_instructions(NoiseProgram &p_program) const override {
+		const NoiseDoubleBuffer<Operands>::Reader operands = _read_operands();
+		if (operands->noises.is_empty()) {
+			return p_program.emit(NoiseProgram::Instruction());
+		}
+		int result = _emit_operand(p_program, *operands, 0);
+		for (uint32_t i = 1; i < operands->noises.size(); ++i) {
+			NoiseProgram::Instruction instruction;
+			instruction.op = Derived::OPCODE;
+			instruction.src[0] = result;
+			instruction.src[1] = _emit_operand(p_program, *operands, i);
+			result = p_program.emit(instruction);
+		}
+		return result;
+	}
+
+private:
+	static real_t _sample(const Ref<Noise> &p_noise, real_t p_x) { return p_noise->get_noise_1d(p_x); }
+	static real_t _sample(const Ref<Noise> &p_noise, const Vector2 &p_v) { return p_noise->get_noise_2d(p_v.x, p_v.y); }
+	static real_t _sample(const Ref<Noise> &p_noise, const Vector3 &p_v) { return p_noise->get_noise_3d(p_v.x, p_v.y, p_v.z); }
+
+	template <typename P>
+	static real_t _sample_operand(const Operands &p_operands, uint32_t p_index, const P &p_point) {
+		const Ref<Noise> &noise = p_operands.noises[p_index];
+		if (noise.is_null()) {
+			return 0.;
+		}
+		const real_t weight = p_operands.weights[p_index];
+		const real_t value = _sample(noise, p_point);
+		return weight == 1. ? value : weight * value;
+	}
+
+	template <typename P>
+	static void _sample_operand_batch(const Operands &p_operands, uint32_t p_index, const P *p_points, real_t *r_values, int p_count) {
+		sample_batch(p_operands.noises[p_index], p_points, r_values, p_count);
+		const real_t weight = p_operands.weights[p_index];
+		if (weight != 1. && p_operands.noises[p_index].is_valid()) {
+			NoiseKernels::affine(r_values, r_values, p_count, weight, 0.);
+		}
+	}
+
+	template <typename P>
+	static real_t _sample_operand_gradient(const Operands &p_operands, uint32_t p_index, const P &p_point, P &r_gradient) {
+		const real_t value = get_gradient(p_operands.noises[p_index], p_point, r_gradient);
+		const real_t weight = p_operands.weights[p_index];
+		if (weight == 1.) {
+			return value;
+		}
+		r_gradient *= weight;
+		return weight * value;
+	}
+
+	static NoiseInterval _get_operand_interval(const Operands &p_operands, uint32_t p_index, const NoiseRegion &p_region, bool p_strict) {
+		const NoiseInterval interval = get_interval(p_operands.noises[p_index], p_region, p_strict);
+		const real_t weight = p_operands.weights[p_index];
+		return weight == 1. || p_operands.noises[p_index].is_null() ? interval : NoiseInterval::affine(interval, weight, 0.);
+	}
+
+	static int _emit_operand(NoiseProgram &p_program, const Operands &p_operands, uint32_t p_index) {
+		const int value = p_program.compile(p_operands.noises[p_index]);
+		const real_t weight = p_operands.weights[p_index];
+		if (weight == 1. || p_operands.noises[p_index].is_null()) {
+			return value;
+		}
+		NoiseProgram::Instruction instruction;
+		instruction.op = NoiseProgram::OP_AFFINE;
+		instruction.src[0] = value;
+		instruction.param = { { weight, 0., 0. } };
+		return p_program.emit(instruction);
+	}
+
+	template <typename P>
+	real_t _evaluate(const P &p_point) const {
+		const NoiseDoubleBuffer<Operands>::Reader operands = _read_operands();
+		const uint32_t count = operands->noises.size();
+		if (count == 0) {
+			return 0.;
+		}
+		real_t result = _sample_operand(*operands, 0, p_point);
+		for (uint32_t i = 1; i < count && !Derived::is_absorbing(result); ++i) {
+			result = Derived::combine(result, _sample_operand(*operands, i, p_point));
+		}
+		return result;
+	}
+
+	template <typename P>
+	real_t _evaluate_gradient(const P &p_point, P &r_gradient) const {
+		const NoiseDoubleBuffer<Operands>::Reader operands = _read_operands();
+		const uint32_t count = operands->noises.size();
+		if (count == 0) {
+			r_gradient = P();
+			return 0.;
+		}
+		real_t result = _sample_operand_gradient(*operands, 0, p_point, r_gradient);
+		for (uint32_t i = 1; i < count; ++i) {
+			P gradient;
+			const real_t value = _sample_operand_gradient(*operands, i, p_point, gradient);
+			result = Derived::combine_gradient(result, r_gradient, value, gradient);
+		}
+		return result;
+	}
+
+	// Operands are sampled one after the other over the block, each being folded into the result at once.
+	// Lanes already absorbed keep their result, as they would point by point.
+	template <typename P>
+	void _evaluate_block(const Operands &p_operands, const P *p_points, real_t *r_values, int p_count) const {
+		const uint32_t count = p_operands.noises.size();
+		if (count == 0) {
+			std::fill(r_values, r_values + p_count, real_t(0.));
+			return;
+		}
+		_sample_operand_batch(p_operands, 0, p_points, r_values, p_count);
+		real_t buffer[BATCH_SIZE];
+		for (uint32_t i = 1; i < count; ++i) {
+			const int absorbed = _count_absorbed(r_values, p_count);
+			if (absorbed == p_count) {
+				return;
+			}
+			_sample_operand_batch(p_operands, i, p_points, buffer, p_count);
+			if (absorbed == 0) {
+				Derived::combine_batch(r_values, buffer, r_values, p_count);
+				continue;
+			}
+			for (int j = 0; j < p_count; ++j) {
+				if (!Derived::is_absorbing(r_values[j])) {
+					r_values[j] = Derived::combine(r_values[j], buffer[j]);
+				}
+			}
+		}
+	}
+
+	static int _count_absorbed(const real_t *p_values, int p_count) {
+		int absorbed = 0;
+		for (int i = 0; i < p_count; ++i) {
+			absorbed += Derived::is_absorbing(p_values[i]) ? 1 : 0;
+		}
+		return absorbed;
+	}
+
+	template <typename P>
+	void _get_noise_batch(const P *p_points, real_t *r_values, int p_count) const {
+		NOISE_PROFILE_SCOPE(p_count);
+		const NoiseDoubleBuffer<Operands>::Reader operands = _read_operands();
+		for (int offset = 0; offset < p_count; offset += BATCH_SIZE) {
+			_evaluate_block(*operands, p_points + offset, r_values + offset, MIN(BATCH_SIZE, p_count - offset));
+		}
 	}
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,125 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_profiler.h"
+
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+
+#include "core/os/thread.h"
+#include <chrono>
+
+std::atomic<bool> NoiseProfiler::enabled{ false };
+std::atomic<bool> NoiseProfiler::recorded{ false };
+BinaryMutex NoiseProfiler::tables_mutex;
+LocalVector<NoiseProfiler::ThreadTable *> NoiseProfiler::tables;
+
+thread_local NoiseProfileScope *NoiseProfileScope::current = nullptr;
+
+static uint64_t _get_time_nsec() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void NoiseProfiler::Counters::add(const Counters &p_other) {
+	calls += p_other.calls;
+	samples += p_other.samples;
+	inclusive_nsec += p_other.inclusive_nsec;
+	exclusive_nsec += p_other.exclusive_nsec;
+	cache_hits += p_other.cache_hits;
+	cache_misses += p_other.cache_misses;
+}
+
+void NoiseProfiler::reset() {
+	MutexLock lock(tables_mutex);
+	for (ThreadTable *table : tables) {
+		MutexLock table_lock(table->mutex);
+		table->counters.clear();
+	}
+}
+
+NoiseProfiler::ThreadTable *NoiseProfiler::_get_thread_table() {
+	static thread_local ThreadTable *table = nullptr;
+	if (unlikely(!table)) {
+		table = memnew(ThreadTable);
+		table->thread_id = Thread::get_caller_id();
+		MutexLock lock(tables_mutex);
+		tables.push_back(table);
+		recorded.store(true, std::memory_order_release);
+	}
+	return table;
+}
+
+void NoiseProfiler::record_call(const NoiseNode *p_node, uint64_t p_samples, uint64_t p_inclusive_nsec, uint64_t p_exclusive_nsec) {
+	ThreadTable *table = _get_thread_table();
+	MutexLock lock(table->mutex);
+	Counters &counters = table->counters[p_node];
+	++counters.calls;
+	counters.samples += p_samples;
+	counters.inclusive_nsec += p_inclusive_nsec;
+	counters.exclusive_nsec += p_exclusive_nsec;
+}
+
+void NoiseProfiler::record_cache(const NoiseNode *p_node, uint64_t p_hits, uint64_t p_misses) {
+	ThreadTable *table = _get_thread_table();
+	MutexLock lock(table->mutex);
+	Counters &counters = table->counters[p_node];
+	counters.cache_hits += p_hits;
+	counters.cache_misses += p_misses;
+}
+
+void NoiseProfiler::get_counters(const NoiseNode *p_node, HashMap<uint64_t, Counters> &r_threads) {
+	MutexLock lock(tables_mutex);
+	for (ThreadTable *table : tables) {
+		MutexLock table_lock(table->mutex);
+		const Counters *counters = table->counters.getptr(p_node);
+		if (counters) {
+			r_threads[table->thread_id].add(*counters);
+		}
+	}
+}
+
+void NoiseProfiler::_forget(const NoiseNode *p_node) {
+	MutexLock lock(tables_mutex);
+	for (ThreadTable *table : tables) {
+		MutexLock table_lock(table->mutex);
+		table->counters.erase(p_node);
+	}
+}
+
+void NoiseProfileScope::_begin(const NoiseNode *p_node, int p_samples) {
+	node = p_node;
+	samples = p_samples;
+	parent = current;
+	current = this;
+	start = _get_time_nsec();
+}
+
+void NoiseProfileScope::_end() {
+	const uint64_t elapsed = _get_time_nsec() - start;
+	current = parent;
+	if (parent) {
+		parent->children_nsec += elapsed;
+	}
+	NoiseProfiler::record_call(node, samples, elapsed, elapsed - MIN(elapsed, children_nsec));
+}
+
+#endif
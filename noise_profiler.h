@@ -0,0 +1,131 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_PROFILER_H
+#define NOISE_PROFILER_H
+
+// Profiling of the evaluation of the nodes, built when NOISE_COMPOSER_PROFILING_ENABLED is defined (the
+// noise_composer_profiling build option, on by default) and recording only once enabled at runtime. Disabled,
+// an instrumented call costs one test of a flag.
+
+#ifdef NOISE_COMPOSER_PROFILING_ENABLED
+
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include <atomic>
+
+class NoiseNode;
+
+class NoiseProfiler {
+public:
+	struct Counters {
+		uint64_t calls{ 0 };
+		uint64_t samples{ 0 };
+		uint64_t inclusive_nsec{ 0 };
+		uint64_t exclusive_nsec{ 0 };
+		uint64_t cache_hits{ 0 };
+		uint64_t cache_misses{ 0 };
+
+		void add(const Counters &p_other);
+	};
+
+	static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+	static void set_enabled(bool p_enabled) { enabled.store(p_enabled, std::memory_order_relaxed); }
+	static void reset();
+
+	static void record_call(const NoiseNode *p_node, uint64_t p_samples, uint64_t p_inclusive_nsec, uint64_t p_exclusive_nsec);
+	static void record_cache(const NoiseNode *p_node, uint64_t p_hits, uint64_t p_misses);
+
+	// Counters of the node, per thread id.
+	static void get_counters(const NoiseNode *p_node, HashMap<uint64_t, Counters> &r_threads);
+	// Drops the counters of a node being destroyed, so that they are not given to a later node at the same address.
+	// Free until profiling has recorded something.
+	static void forget(const NoiseNode *p_node) {
+		if (unlikely(recorded.load(std::memory_order_acquire))) {
+			_forget(p_node);
+		}
+	}
+
+private:
+	// Counters of the nodes evaluated by one thread. Only that thread writes them, the lock is only contended
+	// while the counters are read.
+	struct ThreadTable {
+		uint64_t thread_id{ 0 };
+		BinaryMutex mutex;
+		HashMap<const NoiseNode *, Counters> counters;
+	};
+
+	static ThreadTable *_get_thread_table();
+	static void _forget(const NoiseNode *p_node);
+
+	static std::atomic<bool> enabled;
+	// Set once the first thread table exists, counters are only ever kept in those.
+	static std::atomic<bool> recorded;
+	static BinaryMutex tables_mutex;
+	// Tables outlive their threads, so that the work of a finished thread is still reported.
+	static LocalVector<ThreadTable *> tables;
+};
+
+// Records a call to a node, from its construction to its destruction. Time spent in the calls recorded meanwhile
+// on the same thread is excluded from the exclusive time of the node.
+class NoiseProfileScope {
+public:
+	NoiseProfileScope(const NoiseNode *p_node, int p_samples) {
+		if (unlikely(NoiseProfiler::is_enabled())) {
+			_begin(p_node, p_samples);
+		}
+	}
+	~NoiseProfileScope() {
+		if (unlikely(node)) {
+			_end();
+		}
+	}
+
+private:
+	void _begin(const NoiseNode *p_node, int p_samples);
+	void _end();
+
+	const NoiseNode *node{ nullptr };
+	NoiseProfileScope *parent{ nullptr };
+	uint64_t samples{ 0 };
+	uint64_t start{ 0 };
+	uint64_t children_nsec{ 0 };
+
+	static thread_local NoiseProfileScope *current;
+};
+
+#define NOISE_PROFILE_SCOPE(m_samples) NoiseProfileScope _profile_scope(this, m_samples)
+#define NOISE_PROFILE_CACHE(m_hits, m_misses)                   \
+	if (unlikely(NoiseProfiler::is_enabled())) {                \
+		NoiseProfiler::record_cache(this, m_hits, m_misses); \
+	}
+
+#else
+
+#define NOISE_PROFILE_SCOPE(m_samples)
+#define NOISE_PROFILE_CACHE(m_hits, m_misses)
+
+#endif
+
+#endif
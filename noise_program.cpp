@@ -0,0 +1,877 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_program.h"
+#include "core/object/class_db.h"
+#include "noise_composer.h"
+#include "noise_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+void NoiseProgram::clear() {
+	code.clear();
+	sources.clear();
+	user_counts.clear();
+	decisions.clear();
+	nodes.clear();
+	compiled.clear();
+	optimization_log.clear();
+	original_listing = String();
+	region = NoiseRegion();
+	register_count = 0;
+	shared_node_count = 0;
+	removed_instruction_count = 0;
+	pruned_node_count = 0;
+	result = -1;
+}
+
+void NoiseProgram::build(const Ref<Noise> &p_noise, bool p_optimize, const NoiseRegion &p_region) {
+	clear();
+	region = p_region;
+	compile(p_noise);
+	if (p_optimize) {
+		optimize();
+	}
+	_prepare_decisions();
+	_allocate_registers();
+}
+
+int NoiseProgram::compile(const Ref<Noise> &p_noise) {
+	if (p_noise.is_null()) {
+		Instruction zero;
+		zero.op = OP_CONSTANT;
+		result = emit(zero);
+		return result;
+	}
+	const int *known = compiled.getptr(p_noise.ptr());
+	if (known) {
+		++shared_node_count;
+		result = *known;
+		return result;
+	}
+	const NoiseNode *node = Object::cast_to<NoiseNode>(p_noise.ptr());
+	int reg = -1;
+	if (node && region.is_bounded()) {
+		real_t value = 0.;
+		const int pruned = node->prune(region, value);
+		if (pruned == NoiseNode::PRUNE_CONSTANT) {
+			Instruction constant;
+			constant.op = OP_CONSTANT;
+			constant.param[0] = value;
+			reg = emit(constant);
+		} else if (pruned >= 0) {
+			reg = compile(node->get_child(pruned));
+		}
+		pruned_node_count += reg >= 0;
+	}
+	if (reg < 0 && node) {
+		reg = node->emit_instructions(*this);
+	}
+	if (reg < 0) {
+		Instruction leaf;
+		leaf.op = OP_LEAF;
+		reg = emit(leaf, p_noise);
+	}
+	compiled.insert(p_noise.ptr(), reg);
+	result = reg;
+	return reg;
+}
+
+int NoiseProgram::emit(Instruction p_instruction, const Ref<Noise> &p_node) {
+	if (p_node.is_valid()) {
+		p_instruction.node = nodes.size();
+		nodes.push_back(p_node);
+	}
+	p_instruction.dst = register_count++;
+	code.push_back(p_instruction);
+	return p_instruction.dst;
+}
+
+const char *NoiseProgram::get_op_name(OpCode p_op) {
+	switch (p_op) {
+		case OP_CONSTANT:
+			return "constant";
+		case OP_LEAF:
+			return "leaf";
+		case OP_ADD:
+			return "add";
+		case OP_MULTIPLY:
+			return "multiply";
+		case OP_MAX:
+			return "max";
+		case OP_MIN:
+			return "min";
+		case OP_POWER:
+			return "power";
+		case OP_ABSOLUTE:
+			return "absolute";
+		case OP_INVERT:
+			return "invert";
+		case OP_CLAMP:
+			return "clamp";
+		case OP_AFFINE:
+			return "affine";
+		case OP_MIX:
+			return "mix";
+		case OP_SELECT:
+			return "select";
+		case OP_CURVE:
+			return "curve";
+		case OP_POWER_CONSTANT:
+			return "power_constant";
+	}
+	return "unknown";
+}
+
+static int _get_operand_count(NoiseProgram::OpCode p_op) {
+	switch (p_op) {
+		case NoiseProgram::OP_CONSTANT:
+		case NoiseProgram::OP_LEAF:
+			return 0;
+		case NoiseProgram::OP_ABSOLUTE:
+		case NoiseProgram::OP_INVERT:
+		case NoiseProgram::OP_CLAMP:
+		case NoiseProgram::OP_AFFINE:
+		case NoiseProgram::OP_CURVE:
+		case NoiseProgram::OP_POWER_CONSTANT:
+			return 1;
+		case NoiseProgram::OP_MIX:
+		case NoiseProgram::OP_SELECT:
+			return 3;
+		default:
+			return 2;
+	}
+}
+
+NoiseInterval NoiseProgram::_get_interval(const Instruction &p_instruction, const LocalVector<NoiseInterval> &p_intervals) const {
+	const NoiseInterval &a = p_intervals[p_instruction.src[0]];
+	const NoiseInterval &b = p_intervals[p_instruction.src[1]];
+	const NoiseInterval &c = p_intervals[p_instruction.src[2]];
+	const real_t *param = p_instruction.param.data();
+	switch (p_instruction.op) {
+		case OP_CONSTANT:
+			return NoiseInterval::point(param[0]);
+		case OP_LEAF:
+			// Values must not change, leaves are only trusted with strict bounds.
+			return NoiseNode::get_interval(nodes[p_instruction.node], region, true);
+		case OP_ADD:
+			return NoiseInterval::add(a, b);
+		case OP_MULTIPLY:
+			return NoiseInterval::multiply(a, b);
+		case OP_MAX:
+			return NoiseInterval::max(a, b);
+		case OP_MIN:
+			return NoiseInterval::min(a, b);
+		case OP_POWER:
+			return NoiseInterval::power(a, b);
+		case OP_ABSOLUTE:
+			return NoiseInterval::absolute(a);
+		case OP_INVERT:
+			return NoiseInterval::invert(a);
+		case OP_CLAMP:
+			return NoiseInterval::clamp(a, param[0], param[1], param[2]);
+		case OP_AFFINE:
+			return NoiseInterval::affine(a, param[0], param[1]);
+		case OP_MIX:
+			return NoiseInterval::mix(a, b, c);
+		case OP_SELECT:
+			return NoiseInterval::select(a, b, c, param[0]);
+		case OP_CURVE:
+			// Exact bounds of the table the curve is evaluated with.
+			return static_cast<const CurveNoise *>(nodes[p_instruction.node].ptr())->get_value_interval(a);
+		case OP_POWER_CONSTANT:
+			return NoiseInterval::power(a, NoiseKernels::Exponent::make(param[0], param[1] != 0.));
+	}
+	return NoiseInterval();
+}
+
+void NoiseProgram::optimize() {
+	// Instructions are rewritten in place, in emission order. A register that turns out to hold the same
+	// value as another one is aliased to it, and everything left unused is removed at the end.
+	LocalVector<int> alias;
+	LocalVector<NoiseInterval> ranges;
+	alias.resize(code.size());
+	ranges.resize(code.size());
+	const uint32_t initial_count = code.size();
+	original_listing = get_listing();
+
+	auto is_constant = [&](int p_register, real_t p_value) {
+		return code[p_register].op == OP_CONSTANT && code[p_register].param[0] == p_value;
+	};
+	auto log = [&](const Instruction &p_instruction, const String &p_action) {
+		optimization_log.push_back(vformat("r%d (%s): %s", p_instruction.dst, get_op_name(p_instruction.op), p_action));
+	};
+
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		Instruction &ins = code[i];
+		alias[i] = i;
+		const int operand_count = _get_operand_count(ins.op);
+		bool constant_operands = operand_count > 0;
+		for (int j = 0; j < operand_count; ++j) {
+			ins.src[j] = alias[ins.src[j]];
+			constant_operands = constant_operands && code[ins.src[j]].op == OP_CONSTANT;
+		}
+
+		if (constant_operands) {
+			real_t operands[3] = { 0., 0., 0. };
+			for (int j = 0; j < operand_count; ++j) {
+				operands[j] = code[ins.src[j]].param[0];
+			}
+			real_t value;
+			_apply(ins, &operands[0], &operands[1], &operands[2], &value, 1);
+			log(ins, vformat("folded into constant %f", value));
+			ins.op = OP_CONSTANT;
+			ins.param = { { value, 0., 0. } };
+			ins.node = -1;
+		} else {
+			const Instruction &first = code[ins.src[0]];
+			int same_as = -1;
+			switch (ins.op) {
+				case OP_ADD:
+					if (is_constant(ins.src[0], 0.)) {
+						same_as = ins.src[1];
+					} else if (is_constant(ins.src[1], 0.)) {
+						same_as = ins.src[0];
+					}
+					break;
+				case OP_MULTIPLY:
+					if (is_constant(ins.src[0], 1.)) {
+						same_as = ins.src[1];
+					} else if (is_constant(ins.src[1], 1.)) {
+						same_as = ins.src[0];
+					} else if (is_constant(ins.src[0], 0.) || is_constant(ins.src[1], 0.)) {
+						log(ins, "multiplied by zero");
+						ins.op = OP_CONSTANT;
+						ins.param = { { 0., 0., 0. } };
+					}
+					break;
+				case OP_ABSOLUTE:
+					if (first.op == OP_ABSOLUTE || ranges[ins.src[0]].lower >= 0.) {
+						same_as = ins.src[0];
+					}
+					break;
+				case OP_INVERT:
+					if (first.op == OP_INVERT) {
+						same_as = first.src[0];
+					}
+					break;
+				case OP_CLAMP: {
+					const NoiseInterval &source = ranges[ins.src[0]];
+					if (ins.param[2] == 0. && source.is_within(ins.param[0], ins.param[1])) {
+						same_as = ins.src[0];
+					} else if (source.upper <= ins.param[0] || source.lower >= ins.param[1]) {
+						const real_t bound = source.upper <= ins.param[0] ? ins.param[0] : ins.param[1];
+						const real_t value = NoiseKernels::clamp(bound, ins.param[0], ins.param[1], ins.param[2]);
+						log(ins, vformat("saturated to constant %f", value));
+						ins.op = OP_CONSTANT;
+						ins.param = { { value, 0., 0. } };
+					}
+				} break;
+				case OP_AFFINE:
+					if (first.op == OP_AFFINE) {
+						log(ins, vformat("merged with r%d", first.dst));
+						ins.param[1] = (ins.param[0] * first.param[1]) + ins.param[1];
+						ins.param[0] = ins.param[0] * first.param[0];
+						ins.src[0] = first.src[0];
+					}
+					if (ins.param[0] == 1. && ins.param[1] == 0.) {
+						same_as = ins.src[0];
+					}
+					break;
+				default:
+					break;
+			}
+			if (same_as >= 0) {
+				log(ins, vformat("replaced by r%d", same_as));
+				alias[i] = same_as;
+			}
+		}
+		ranges[i] = alias[i] == (int)i ? _get_interval(ins, ranges) : ranges[alias[i]];
+	}
+	if (result >= 0) {
+		result = alias[result];
+	}
+
+	// Dead code elimination, walking back from the result.
+	LocalVector<bool> live;
+	live.resize(code.size());
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		live[i] = (int)i == result;
+	}
+	for (int i = code.size() - 1; i >= 0; --i) {
+		if (!live[i]) {
+			continue;
+		}
+		for (int j = 0; j < _get_operand_count(code[i].op); ++j) {
+			live[code[i].src[j]] = true;
+		}
+	}
+	LocalVector<int> renumber;
+	renumber.resize(code.size());
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		if (!live[i]) {
+			continue;
+		}
+		Instruction ins = code[i];
+		for (int j = 0; j < _get_operand_count(ins.op); ++j) {
+			ins.src[j] = renumber[ins.src[j]];
+		}
+		renumber[i] = kept;
+		ins.dst = kept;
+		code[kept++] = ins;
+	}
+	code.resize(kept);
+	register_count = kept;
+	if (result >= 0) {
+		result = renumber[result];
+	}
+	removed_instruction_count = initial_count - kept;
+}
+
+void NoiseProgram::_allocate_registers() {
+	// Instructions are emitted after their operands, so the code is already in topological order and a
+	// single pass finds the last reader of every value.
+	LocalVector<int> last_use;
+	last_use.resize(register_count);
+	for (int &use : last_use) {
+		use = -1;
+	}
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		for (int j = 0; j < _get_operand_count(code[i].op); ++j) {
+			last_use[code[i].src[j]] = i;
+		}
+	}
+	if (result >= 0) {
+		last_use[result] = code.size();
+	}
+
+	// Every kernel works lane by lane, so an instruction can write into a register it has just read.
+	LocalVector<int> assigned;
+	assigned.resize(register_count);
+	LocalVector<int> free_registers;
+	int used = 0;
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		Instruction &ins = code[i];
+		const int value = ins.dst;
+		for (int j = 0; j < _get_operand_count(ins.op); ++j) {
+			const int operand = ins.src[j];
+			ins.src[j] = assigned[operand];
+			if (last_use[operand] == (int)i) {
+				free_registers.push_back(assigned[operand]);
+				last_use[operand] = -1;
+			}
+		}
+		if (free_registers.is_empty()) {
+			assigned[value] = used++;
+		} else {
+			assigned[value] = free_registers[free_registers.size() - 1];
+			free_registers.resize(free_registers.size() - 1);
+		}
+		ins.dst = assigned[value];
+		if (last_use[value] < 0) {
+			free_registers.push_back(ins.dst);
+		}
+	}
+	if (result >= 0) {
+		result = assigned[result];
+	}
+	register_count = used;
+}
+
+// Runs before the registers are assigned, while operands are still instruction indices.
+void NoiseProgram::_prepare_decisions() {
+	sources.resize(code.size());
+	user_counts.resize(code.size());
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		sources[i] = code[i].src;
+		user_counts[i] = (int)i == result ? 1 : 0;
+	}
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		const Instruction &ins = code[i];
+		for (int j = 0; j < _get_operand_count(ins.op); ++j) {
+			++user_counts[ins.src[j]];
+		}
+		switch (ins.op) {
+			case OP_MULTIPLY:
+				decisions.push_back({ ins.src[0], (int)i });
+				break;
+			case OP_MIX:
+			case OP_SELECT:
+				decisions.push_back({ ins.src[2], (int)i });
+				break;
+			default:
+				break;
+		}
+	}
+	std::stable_sort(decisions.ptr(), decisions.ptr() + decisions.size(), [](const Decision &a, const Decision &b) { return a.decider < b.decider; });
+}
+
+String NoiseProgram::get_optimization_report() const {
+	// Register numbers in the report are the ones of the original listing.
+	String report = original_listing;
+	report += vformat("%d instruction(s) removed\n", removed_instruction_count);
+	for (const String &line : optimization_log) {
+		report += line + "\n";
+	}
+	return report;
+}
+
+String NoiseProgram::get_listing() const {
+	String listing;
+	for (const Instruction &ins : code) {
+		String line = vformat("r%d = %s", ins.dst, get_op_name(ins.op));
+		for (int i = 0; i < _get_operand_count(ins.op); ++i) {
+			line += vformat(i == 0 ? " r%d" : ", r%d", ins.src[i]);
+		}
+		switch (ins.op) {
+			case OP_CONSTANT:
+			case OP_SELECT:
+			case OP_POWER_CONSTANT:
+				line += vformat(" (%f)", ins.param[0]);
+				break;
+			case OP_AFFINE:
+				line += vformat(" (%f, %f)", ins.param[0], ins.param[1]);
+				break;
+			case OP_CLAMP:
+				line += vformat(" (%f, %f, %f)", ins.param[0], ins.param[1], ins.param[2]);
+				break;
+			default:
+				break;
+		}
+		if (ins.node >= 0) {
+			line += " <" + nodes[ins.node]->get_class() + ">";
+		}
+		listing += line + "\n";
+	}
+	return listing;
+}
+
+void NoiseProgram::_apply(const Instruction &p_instruction, const real_t *p_a, const real_t *p_b, const real_t *p_c, real_t *r_values, int p_count) const {
+	switch (p_instruction.op) {
+		case OP_CONSTANT:
+			std::fill(r_values, r_values + p_count, p_instruction.param[0]);
+			break;
+		case OP_LEAF:
+			break;
+		case OP_ADD:
+			NoiseKernels::add(p_a, p_b, r_values, p_count);
+			break;
+		case OP_MULTIPLY: {
+			// As in MultiplyNoise, the second factor counts as zero where the first one is zero.
+			int lane = 0;
+			while (lane < p_count && p_a[lane] != 0.) {
+				++lane;
+			}
+			if (lane == p_count) {
+				NoiseKernels::multiply(p_a, p_b, r_values, p_count);
+				break;
+			}
+			real_t second[NoiseNode::BATCH_SIZE];
+			for (int i = 0; i < p_count; ++i) {
+				second[i] = p_a[i] == 0. ? 0. : p_b[i];
+			}
+			NoiseKernels::multiply(p_a, second, r_values, p_count);
+		} break;
+		case OP_MAX:
+			NoiseKernels::max(p_a, p_b, r_values, p_count);
+			break;
+		case OP_MIN:
+			NoiseKernels::min(p_a, p_b, r_values, p_count);
+			break;
+		case OP_POWER:
+			for (int i = 0; i < p_count; ++i) {
+				r_values[i] = std::pow(p_a[i], p_b[i]);
+			}
+			break;
+		case OP_ABSOLUTE:
+			NoiseKernels::absolute(p_a, r_values, p_count);
+			break;
+		case OP_INVERT:
+			NoiseKernels::invert(p_a, r_values, p_count);
+			break;
+		case OP_CLAMP:
+			NoiseKernels::clamp(p_a, r_values, p_count, p_instruction.param[0], p_instruction.param[1], p_instruction.param[2]);
+			break;
+		case OP_AFFINE:
+			NoiseKernels::affine(p_a, r_values, p_count, p_instruction.param[0], p_instruction.param[1]);
+			break;
+		case OP_MIX: {
+			// As in MixNoise, an operand counts as zero where its weight is zero.
+			real_t first[NoiseNode::BATCH_SIZE], second[NoiseNode::BATCH_SIZE];
+			for (int i = 0; i < p_count; ++i) {
+				const real_t ratio = (p_c[i] + 1.) / 2.;
+				first[i] = ratio != 1. ? p_a[i] : 0.;
+				second[i] = ratio != 0. ? p_b[i] : 0.;
+			}
+			NoiseKernels::mix(first, second, p_c, r_values, p_count);
+		} break;
+		case OP_SELECT:
+			NoiseKernels::select(p_a, p_b, p_c, r_values, p_count, p_instruction.param[0]);
+			break;
+		case OP_CURVE: {
+			const CurveNoise *curve = static_cast<const CurveNoise *>(nodes[p_instruction.node].ptr());
+			curve->remap(p_a, r_values, p_count);
+		} break;
+		case OP_POWER_CONSTANT:
+			NoiseKernels::power(p_a, r_values, p_count, NoiseKernels::Exponent::make(p_instruction.param[0], p_instruction.param[1] != 0.));
+			break;
+	}
+}
+
+int NoiseProgram::_get_unneeded_operand(const Instruction &p_instruction, const real_t *p_registers, int p_stride, int p_count) const {
+	switch (p_instruction.op) {
+		case OP_MULTIPLY: {
+			const real_t *first = p_registers + (p_instruction.src[0] * p_stride);
+			for (int i = 0; i < p_count; ++i) {
+				if (first[i] != 0.) {
+					return -1;
+				}
+			}
+			return 1;
+		}
+		case OP_MIX:
+		case OP_SELECT: {
+			const real_t *selector = p_registers + (p_instruction.src[2] * p_stride);
+			bool first = false, second = false;
+			for (int i = 0; i < p_count && !(first && second); ++i) {
+				if (p_instruction.op == OP_MIX) {
+					const real_t ratio = (selector[i] + 1.) / 2.;
+					first = first || ratio != 1.;
+					second = second || ratio != 0.;
+				} else {
+					const bool selected = selector[i] < p_instruction.param[0];
+					first = first || selected;
+					second = second || !selected;
+				}
+			}
+			return !first ? 0 : (!second ? 1 : -1);
+		}
+		default:
+			return -1;
+	}
+}
+
+// Instructions left without users drop all of their operands in turn.
+void NoiseProgram::_drop_operand(int p_instruction, int p_operand, Liveness &r_liveness) const {
+	const uint8_t bit = 1 << p_operand;
+	if (r_liveness.dropped[p_instruction] & bit) {
+		return;
+	}
+	r_liveness.dropped[p_instruction] |= bit;
+	int pending_count = 0;
+	r_liveness.pending[pending_count++] = sources[p_instruction][p_operand];
+	while (pending_count > 0) {
+		const int released = r_liveness.pending[--pending_count];
+		if (--r_liveness.users[released] > 0) {
+			continue;
+		}
+		for (int j = 0; j < _get_operand_count(code[released].op); ++j) {
+			if (!(r_liveness.dropped[released] & (1 << j))) {
+				r_liveness.dropped[released] |= 1 << j;
+				r_liveness.pending[pending_count++] = sources[released][j];
+			}
+		}
+	}
+}
+
+template <typename P>
+void NoiseProgram::_execute(const P *p_points, int p_count, real_t *p_registers, int p_stride, Liveness *r_liveness) const {
+	if (r_liveness) {
+		std::copy(user_counts.ptr(), user_counts.ptr() + code.size(), r_liveness->users);
+		std::fill(r_liveness->dropped, r_liveness->dropped + code.size(), 0);
+	}
+	uint32_t decision = 0;
+	for (uint32_t i = 0; i < code.size(); ++i) {
+		const Instruction &ins = code[i];
+		if (r_liveness && r_liveness->users[i] == 0) {
+			continue;
+		}
+		real_t *dst = p_registers + (ins.dst * p_stride);
+		if (ins.op == OP_LEAF) {
+			NoiseNode::sample_batch(nodes[ins.node], p_points, dst, p_count);
+		} else {
+			const real_t *a = p_registers + (ins.src[0] * p_stride);
+			const real_t *b = p_registers + (ins.src[1] * p_stride);
+			const real_t *c = p_registers + (ins.src[2] * p_stride);
+			_apply(ins, a, b, c, dst, p_count);
+		}
+		if (!r_liveness) {
+			continue;
+		}
+		// Instructions deciding on operands not reached yet are evaluated before them where possible.
+		while (decision < decisions.size() && decisions[decision].decider < (int)i) {
+			++decision;
+		}
+		for (; decision < decisions.size() && decisions[decision].decider == (int)i; ++decision) {
+			const int conditional = decisions[decision].instruction;
+			if (r_liveness->users[conditional] == 0) {
+				continue;
+			}
+			const int unneeded = _get_unneeded_operand(code[conditional], p_registers, p_stride, p_count);
+			if (unneeded >= 0) {
+				_drop_operand(conditional, unneeded, *r_liveness);
+			}
+		}
+	}
+}
+
+// Scratch buffers of the programs running on a thread, one per nesting level as leaves may run programs too.
+struct NoiseProgramScratch {
+	LocalVector<real_t> registers;
+	LocalVector<int> users;
+	LocalVector<uint8_t> dropped;
+	LocalVector<int> pending;
+};
+
+// Levels are allocated one by one, so that buffers of the levels below stay where they are.
+struct NoiseProgramScratchStack {
+	LocalVector<NoiseProgramScratch *> levels;
+	uint32_t depth{ 0 };
+
+	~NoiseProgramScratchStack() {
+		for (NoiseProgramScratch *level : levels) {
+			memdelete(level);
+		}
+	}
+};
+
+static thread_local NoiseProgramScratchStack noise_program_scratches;
+
+template <typename P>
+void NoiseProgram::_run(const P *p_points, real_t *r_values, int p_count) const {
+	if (result < 0) {
+		std::fill(r_values, r_values + p_count, 0.);
+		return;
+	}
+	const int size = code.size();
+	const bool decided = !decisions.is_empty();
+	if (p_count == 1 && register_count <= STACK_SIZE && size <= STACK_SIZE) {
+		real_t registers[STACK_SIZE];
+		int users[STACK_SIZE];
+		uint8_t dropped[STACK_SIZE];
+		int pending[3 * STACK_SIZE];
+		Liveness liveness{ users, dropped, pending };
+		_run_blocks(p_points, r_values, 1, 1, registers, decided ? &liveness : nullptr);
+		return;
+	}
+
+	NoiseProgramScratchStack &stack = noise_program_scratches;
+	if (stack.depth == stack.levels.size()) {
+		stack.levels.push_back(memnew(NoiseProgramScratch));
+	}
+	NoiseProgramScratch &scratch = *stack.levels[stack.depth++];
+	const int stride = MIN(p_count, NoiseNode::BATCH_SIZE);
+	if (scratch.registers.size() < uint32_t(register_count * stride)) {
+		scratch.registers.resize(register_count * stride);
+	}
+	Liveness liveness;
+	if (decided) {
+		if (scratch.users.size() < uint32_t(size)) {
+			scratch.users.resize(size);
+			scratch.dropped.resize(size);
+			scratch.pending.resize(3 * size);
+		}
+		liveness = { scratch.users.ptr(), scratch.dropped.ptr(), scratch.pending.ptr() };
+	}
+	_run_blocks(p_points, r_values, p_count, stride, scratch.registers.ptr(), decided ? &liveness : nullptr);
+	--stack.depth;
+}
+
+template <typename P>
+void NoiseProgram::_run_blocks(const P *p_points, real_t *r_values, int p_count, int p_stride, real_t *p_registers, Liveness *r_liveness) const {
+	for (int offset = 0; offset < p_count; offset += p_stride) {
+		const int block = MIN(p_stride, p_count - offset);
+		_execute(p_points + offset, block, p_registers, p_stride, r_liveness);
+		const real_t *values = p_registers + (result * p_stride);
+		std::copy(values, values + block, r_values + offset);
+	}
+}
+
+real_t NoiseProgram::run_1d(real_t p_x) const {
+	real_t value;
+	_run(&p_x, &value, 1);
+	return value;
+}
+
+real_t NoiseProgram::run_2d(real_t p_x, real_t p_y) const {
+	Vector2 v(p_x, p_y);
+	real_t value;
+	_run(&v, &value, 1);
+	return value;
+}
+
+real_t NoiseProgram::run_3d(real_t p_x, real_t p_y, real_t p_z) const {
+	Vector3 v(p_x, p_y, p_z);
+	real_t value;
+	_run(&v, &value, 1);
+	return value;
+}
+
+void NoiseProgram::run_batch(const real_t *p_x, real_t *r_values, int p_count) const {
+	_run(p_x, r_values, p_count);
+}
+
+void NoiseProgram::run_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	_run(p_v, r_values, p_count);
+}
+
+void NoiseProgram::run_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	_run(p_v, r_values, p_count);
+}
+
+// Compiled Noise
+
+CompiledNoise::~CompiledNoise() {
+	if (source.is_valid()) {
+		source->disconnect_changed(callable_mp(this, &CompiledNoise::_changed));
+	}
+}
+
+void CompiledNoise::set_source(Ref<Noise> n) {
+	if (source.is_valid()) {
+		source->disconnect_changed(callable_mp(this, &CompiledNoise::_changed));
+	}
+	source = n;
+	if (source.is_valid()) {
+		source->connect_changed(callable_mp(this, &CompiledNoise::_changed));
+	}
+	_changed();
+}
+
+void CompiledNoise::set_optimize(bool p_optimize) {
+	optimize = p_optimize;
+	_changed();
+}
+
+void CompiledNoise::_ensure_compiled() const {
+	if (!dirty.load(std::memory_order_acquire)) {
+		return;
+	}
+	std::unique_lock<std::shared_mutex> lock(program_mutex);
+	if (dirty.exchange(false, std::memory_order_acq_rel)) {
+		program.clear();
+		if (source.is_valid()) {
+			program.build(source, optimize);
+		}
+	}
+}
+
+real_t CompiledNoise::get_noise_1d(real_t p_x) const {
+	NOISE_PROFILE_SCOPE(1);
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.run_1d(p_x);
+}
+
+real_t CompiledNoise::get_noise_2dv(Vector2 p_v) const {
+	return get_noise_2d(p_v.x, p_v.y);
+}
+
+real_t CompiledNoise::get_noise_2d(real_t p_x, real_t p_y) const {
+	NOISE_PROFILE_SCOPE(1);
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.run_2d(p_x, p_y);
+}
+
+real_t CompiledNoise::get_noise_3dv(Vector3 p_v) const {
+	return get_noise_3d(p_v.x, p_v.y, p_v.z);
+}
+
+real_t CompiledNoise::get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const {
+	NOISE_PROFILE_SCOPE(1);
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.run_3d(p_x, p_y, p_z);
+}
+
+void CompiledNoise::get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	program.run_batch(p_x, r_values, p_count);
+}
+
+void CompiledNoise::get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	program.run_batch(p_v, r_values, p_count);
+}
+
+void CompiledNoise::get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	program.run_batch(p_v, r_values, p_count);
+}
+
+int CompiledNoise::get_instruction_count() const {
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.get_instruction_count();
+}
+
+String CompiledNoise::get_optimization_report() const {
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.get_optimization_report();
+}
+
+int CompiledNoise::get_register_count() const {
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.get_register_count();
+}
+
+int CompiledNoise::get_shared_node_count() const {
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.get_shared_node_count();
+}
+
+String CompiledNoise::get_program_listing() const {
+	_ensure_compiled();
+	std::shared_lock<std::shared_mutex> lock(program_mutex);
+	return program.get_listing();
+}
+
+void CompiledNoise::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_source", "n"), &CompiledNoise::set_source);
+	ClassDB::bind_method(D_METHOD("get_source"), &CompiledNoise::get_source);
+	ClassDB::bind_method(D_METHOD("set_optimize", "optimize"), &CompiledNoise::set_optimize);
+	ClassDB::bind_method(D_METHOD("get_optimize"), &CompiledNoise::get_optimize);
+
+	ClassDB::bind_method(D_METHOD("get_instruction_count"), &CompiledNoise::get_instruction_count);
+	ClassDB::bind_method(D_METHOD("get_register_count"), &CompiledNoise::get_register_count);
+	ClassDB::bind_method(D_METHOD("get_shared_node_count"), &CompiledNoise::get_shared_node_count);
+	ClassDB::bind_method(D_METHOD("get_program_listing"), &CompiledNoise::get_program_listing);
+	ClassDB::bind_method(D_METHOD("get_optimization_report"), &CompiledNoise::get_optimization_report);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "source",
+						 PROPERTY_HINT_RESOURCE_TYPE, "Noise"),
+			"set_source", "get_source");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "optimize"), "set_optimize", "get_optimize");
+}
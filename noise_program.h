@@ -0,0 +1,235 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_PROGRAM_H
+#define NOISE_PROGRAM_H
+
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "noise_base.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+
+// Flat, register based form of a noise graph.
+// Every operator becomes one instruction reading its operands from registers and writing its result
+// to a new one. Anything that cannot be expressed as an instruction is called as a leaf.
+// Nodes referenced several times in the graph are compiled once, and their register is shared by all
+// of their users. Once built, registers are reassigned so that a register is reused as soon as the value
+// it holds is no longer needed. A program may be built for a region of the domain only, in which case nodes
+// whose value over the region is known, or given by one of their operands, are skipped.
+// Like the operators they come from, selects, mixes and multiplications do not need all of their operands:
+// an operand counts as zero on the lanes where its weight is zero, or where the first factor is zero. When no
+// lane of a block needs an operand, the instructions only computing it are skipped for that block. Lanes are
+// not partitioned, so blocks mixing both cases evaluate every operand.
+class NoiseProgram {
+public:
+	enum OpCode : uint8_t {
+		OP_CONSTANT,
+		OP_LEAF,
+		OP_ADD,
+		OP_MULTIPLY,
+		OP_MAX,
+		OP_MIN,
+		OP_POWER,
+		OP_ABSOLUTE,
+		OP_INVERT,
+		OP_CLAMP,
+		OP_AFFINE,
+		OP_MIX,
+		OP_SELECT,
+		OP_CURVE,
+		// Power with the constant exponent param[0], approximated when param[1] is set.
+		OP_POWER_CONSTANT,
+	};
+
+	struct Instruction {
+		OpCode op{ OP_CONSTANT };
+		std::array<int, 3> src{ { 0, 0, 0 } };
+		std::array<real_t, 3> param{ { 0., 0., 0. } };
+		int node{ -1 };
+		int dst{ -1 };
+	};
+
+public:
+	NoiseProgram() {}
+
+	void clear();
+
+	// Compiles the whole graph, optionally simplifies it, and assigns the registers. The program is
+	// only valid for points within the region.
+	void build(const Ref<Noise> &p_noise, bool p_optimize = false, const NoiseRegion &p_region = NoiseRegion());
+
+	// Compiles the given noise, unless already compiled, and returns the register holding its value.
+	int compile(const Ref<Noise> &p_noise);
+
+	// Folds constants and removes operators without effect. Works on freshly compiled code, before
+	// registers are assigned.
+	void optimize();
+
+	// Appends an instruction writing into a new register, and returns that register.
+	int emit(Instruction p_instruction, const Ref<Noise> &p_node = Ref<Noise>());
+
+	bool is_empty() const { return code.is_empty(); }
+	int get_instruction_count() const { return code.size(); }
+	int get_register_count() const { return register_count; }
+	int get_shared_node_count() const { return shared_node_count; }
+	int get_removed_instruction_count() const { return removed_instruction_count; }
+	int get_pruned_node_count() const { return pruned_node_count; }
+	String get_listing() const;
+	String get_optimization_report() const;
+
+	real_t run_1d(real_t p_x) const;
+	real_t run_2d(real_t p_x, real_t p_y) const;
+	real_t run_3d(real_t p_x, real_t p_y, real_t p_z) const;
+
+	void run_batch(const real_t *p_x, real_t *r_values, int p_count) const;
+	void run_batch(const Vector2 *p_v, real_t *r_values, int p_count) const;
+	void run_batch(const Vector3 *p_v, real_t *r_values, int p_count) const;
+
+	static const char *get_op_name(OpCode p_op);
+
+private:
+	// Instructions still needed by the block being executed, in buffers sized to the code.
+	struct Liveness {
+		int *users{ nullptr };
+		// Operands dropped by each instruction, as bits.
+		uint8_t *dropped{ nullptr };
+		// Room for every operand of every instruction, each being released at most once.
+		int *pending{ nullptr };
+	};
+
+	// Programs this small run a single point from buffers on the stack.
+	static constexpr int STACK_SIZE = 64;
+
+	// Conditional instruction, and the instruction whose values tell which of its operands are needed.
+	struct Decision {
+		int decider{ -1 };
+		int instruction{ -1 };
+	};
+
+	void _prepare_decisions();
+
+	template <typename P>
+	void _run(const P *p_points, real_t *r_values, int p_count) const;
+
+	template <typename P>
+	void _run_blocks(const P *p_points, real_t *r_values, int p_count, int p_stride, real_t *p_registers, Liveness *r_liveness) const;
+
+	template <typename P>
+	void _execute(const P *p_points, int p_count, real_t *p_registers, int p_stride, Liveness *r_liveness) const;
+
+	void _apply(const Instruction &p_instruction, const real_t *p_a, const real_t *p_b, const real_t *p_c, real_t *r_values, int p_count) const;
+
+	// Operand of the instruction no lane of the block needs, or -1.
+	int _get_unneeded_operand(const Instruction &p_instruction, const real_t *p_registers, int p_stride, int p_count) const;
+	void _drop_operand(int p_instruction, int p_operand, Liveness &r_liveness) const;
+
+	NoiseInterval _get_interval(const Instruction &p_instruction, const LocalVector<NoiseInterval> &p_intervals) const;
+
+	void _allocate_registers();
+
+private:
+	LocalVector<Instruction> code;
+	// Instructions read by each instruction, and number of their users, the result counting as one.
+	LocalVector<std::array<int, 3>> sources;
+	LocalVector<int> user_counts;
+	// Sorted by decider.
+	LocalVector<Decision> decisions;
+	LocalVector<Ref<Noise>> nodes;
+	HashMap<const Noise *, int> compiled;
+	LocalVector<String> optimization_log;
+	String original_listing;
+	NoiseRegion region;
+	int register_count{ 0 };
+	int shared_node_count{ 0 };
+	int removed_instruction_count{ 0 };
+	int pruned_node_count{ 0 };
+	int result{ -1 };
+};
+
+// Noise evaluating a compiled form of its source graph.
+// The program is rebuilt on the first evaluation following a change anywhere in the graph. Values are the ones
+// of the source graph, unless optimized: merged affine transformations are then rounded once, additions of zero
+// turn -0 into 0 and multiplications by zero drop NaNs and infinities, so values may differ in the last bits.
+class CompiledNoise : public NoiseNode {
+	GDCLASS(CompiledNoise, NoiseNode)
+	OBJ_SAVE_TYPE(CompiledNoise)
+
+public:
+	CompiledNoise() :
+			NoiseNode(1) {}
+	virtual ~CompiledNoise();
+
+	void set_source(Ref<Noise> n);
+	Ref<Noise> get_source() const { return source; }
+
+	void set_optimize(bool p_optimize);
+	bool get_optimize() const { return optimize; }
+
+	virtual Ref<Noise> get_child(int) const override { return source; }
+
+	virtual NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override { return get_interval(source, p_region, p_strict); }
+
+	virtual real_t get_noise_1d(real_t p_x) const override;
+
+	virtual real_t get_noise_2dv(Vector2 p_v) const override;
+	virtual real_t get_noise_2d(real_t p_x, real_t p_y) const override;
+
+	virtual real_t get_noise_3dv(Vector3 p_v) const override;
+	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override;
+
+	virtual void get_noise_1d_batch(const real_t *p_x, real_t *r_values, int p_count) const override;
+	virtual void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override;
+	virtual void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override;
+
+	virtual real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const override { return get_gradient(source, p_v, r_gradient); }
+	virtual real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const override { return get_gradient(source, p_v, r_gradient); }
+
+	int get_instruction_count() const;
+	int get_register_count() const;
+	int get_shared_node_count() const;
+	String get_program_listing() const;
+	String get_optimization_report() const;
+
+protected:
+	void _changed() {
+		dirty.store(true, std::memory_order_release);
+		_notify_changed();
+	}
+
+	static void _bind_methods();
+
+private:
+	void _ensure_compiled() const;
+
+private:
+	Ref<Noise> source;
+	bool optimize{ false };
+	mutable NoiseProgram program;
+	mutable std::atomic<bool> dirty{ true };
+	mutable std::shared_mutex program_mutex;
+};
+
+#endif
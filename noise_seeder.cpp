@@ -1,10 +1,6 @@
 #include "noise_seeder.h"
+#include "core/templates/hashfuncs.h"
 #include "noise_base.h"
-#include <cstdint>
-#include <map>
-#include <queue>
-#include <random>
-#include <set>
 
 void NoiseSeeder::set_noise(Ref<Noise> n) {
 	noise = n;
@@ -16,49 +12,92 @@ Ref<Noise> NoiseSeeder::get_noise() const { return noise; }
 
 void NoiseSeeder::set_seed(int s) {
 	seed = s;
-	std::mt19937 rand_e;
-	rand_e.seed(seed);
-	std::uniform_int_distribution<int> rand_d;
-
 	if (!noise.is_valid()) {
 		return;
 	}
+	LocalVector<Leaf> leaves;
+	_collect_leaves(leaves);
+	_apply(leaves, nullptr);
+}
 
-	std::map<uint64_t, Ref<Noise>> to_seed;
-	std::set<Ref<Noise>> checked;
-	std::queue<Ref<Noise>> to_check;
+int NoiseSeeder::get_seed() const { return seed; }
 
-	to_check.push(noise);
+void NoiseSeeder::reseed_subtree(Ref<Noise> p_subtree) {
+	ERR_FAIL_COND(p_subtree.is_null());
 
-	while (!to_check.empty()) {
-		Ref<Noise> t = to_check.front();
-		if (!t.is_valid()) {
+	HashSet<const Noise *> reached;
+	LocalVector<Ref<Noise>> to_check;
+	to_check.push_back(p_subtree);
+	while (!to_check.is_empty()) {
+		Ref<Noise> t = to_check[to_check.size() - 1];
+		to_check.resize(to_check.size() - 1);
+		if (t.is_null() || reached.has(t.ptr())) {
 			continue;
 		}
-		to_check.pop();
-
-		if (t->is_class("NoiseNode")) {
-			// It's pretty secure at this point ...
-			NoiseNode *node = reinterpret_cast<NoiseNode *>(t.ptr());
-			for (auto n : *node) {
-				auto it = checked.find(n);
-				if (it == checked.end()) {
-					to_check.push(n);
-					checked.insert(n);
-				}
+		reached.insert(t.ptr());
+		NoiseNode *node = Object::cast_to<NoiseNode>(t.ptr());
+		if (node) {
+			for (Ref<Noise> n : *node) {
+				to_check.push_back(n);
 			}
-		} else if (t->has_method("set_seed")) {
-			to_seed[t->get_instance_id()] = t;
 		}
 	}
 
-	for (auto e : to_seed) {
-		int local_seed = rand_d(rand_e);
-		e.second->call_deferred("set_seed", local_seed);
+	LocalVector<Leaf> leaves;
+	_collect_leaves(leaves);
+	_apply(leaves, &reached);
+}
+
+int NoiseSeeder::get_leaf_seed(Ref<Noise> p_leaf) const {
+	LocalVector<Leaf> leaves;
+	_collect_leaves(leaves);
+	for (const Leaf &leaf : leaves) {
+		if (leaf.noise == p_leaf) {
+			return leaf.seed;
+		}
 	}
+	return 0;
 }
 
-int NoiseSeeder::get_seed() const { return seed; }
+void NoiseSeeder::_collect_leaves(LocalVector<Leaf> &r_leaves) const {
+	if (noise.is_null()) {
+		return;
+	}
+	// Depth first walk, operands in order. Nodes reached several times keep the hash of their first path.
+	struct Step {
+		Ref<Noise> noise;
+		uint32_t hash;
+	};
+	HashSet<const Noise *> checked;
+	LocalVector<Step> to_check;
+	to_check.push_back({ noise, hash_murmur3_one_32(seed) });
+	while (!to_check.is_empty()) {
+		Step t = to_check[to_check.size() - 1];
+		to_check.resize(to_check.size() - 1);
+		if (t.noise.is_null() || checked.has(t.noise.ptr())) {
+			continue;
+		}
+		checked.insert(t.noise.ptr());
+
+		NoiseNode *node = Object::cast_to<NoiseNode>(t.noise.ptr());
+		if (node) {
+			for (int i = node->get_child_count() - 1; i >= 0; --i) {
+				to_check.push_back({ node->get_child(i), hash_murmur3_one_32(i, t.hash) });
+			}
+		} else if (t.noise->has_method(SNAME("set_seed"))) {
+			r_leaves.push_back({ t.noise, int(hash_fmix32(t.hash)) });
+		}
+	}
+}
+
+void NoiseSeeder::_apply(const LocalVector<Leaf> &p_leaves, const HashSet<const Noise *> *p_filter) {
+	NoiseNode::BatchGuard batch;
+	for (const Leaf &leaf : p_leaves) {
+		if (!p_filter || p_filter->has(leaf.noise.ptr())) {
+			leaf.noise->call(SNAME("set_seed"), leaf.seed);
+		}
+	}
+}
 
 void NoiseSeeder::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_noise", "n"), &NoiseSeeder::set_noise);
@@ -67,8 +106,11 @@ void NoiseSeeder::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_seed", "s"), &NoiseSeeder::set_seed);
 	ClassDB::bind_method(D_METHOD("get_seed"), &NoiseSeeder::get_seed);
 
+	ClassDB::bind_method(D_METHOD("reseed_subtree", "subtree"), &NoiseSeeder::reseed_subtree);
+	ClassDB::bind_method(D_METHOD("get_leaf_seed", "leaf"), &NoiseSeeder::get_leaf_seed);
+
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "noise",
 						 PROPERTY_HINT_RESOURCE_TYPE, "Noise"),
 			"set_noise", "get_noise");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
-}
\ No newline at end of file
+}
@@ -1,8 +1,12 @@
 #ifndef NOISE_SEEDER_H
 #define NOISE_SEEDER_H
 
+#include "core/templates/hash_set.h"
+#include "core/templates/local_vector.h"
 #include "modules/noise/noise.h"
 
+// Seeds every leaf of a noise graph from a single seed. The seed of a leaf only depends on the seed of the
+// seeder and on the position of the leaf in the graph, as the path of operand indices leading to it.
 class NoiseSeeder : public Resource {
 	GDCLASS(NoiseSeeder, Resource);
 	OBJ_SAVE_TYPE(NoiseSeeder);
@@ -18,9 +22,26 @@ public:
 
 	int get_seed() const;
 
+	// Seeds again the leaves below the given node of the graph only, with the seeds they get from the whole graph.
+	void reseed_subtree(Ref<Noise> p_subtree);
+
+	// Seed a leaf is given, or 0 when not part of the graph.
+	int get_leaf_seed(Ref<Noise> p_leaf) const;
+
 protected:
 	static void _bind_methods();
 
+private:
+	struct Leaf {
+		Ref<Noise> noise;
+		int seed{ 0 };
+	};
+
+	// Leaves of the graph in a fixed order, each with the seed derived from its first path.
+	void _collect_leaves(LocalVector<Leaf> &r_leaves) const;
+	// Seeds the leaves, notifying the change of the graph once.
+	static void _apply(const LocalVector<Leaf> &p_leaves, const HashSet<const Noise *> *p_filter);
+
 private:
 	Ref<Noise> noise;
 	int seed{ 0 };
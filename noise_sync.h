@@ -0,0 +1,154 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_SYNC_H
+#define NOISE_SYNC_H
+
+#include "core/os/spin_lock.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// Value published by writers and read without blocking.
+// Readers copy the value and retry when a write happened meanwhile (sequence lock), they never block a
+// writer nor each other. Writers are serialized. Meant for small values rarely written and often read.
+template <typename T>
+class NoiseSnapshot {
+	static_assert(std::is_trivially_copyable<T>::value, "Snapshots are copied bytewise");
+	static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+	NoiseSnapshot(const T &p_value = T()) { store(p_value); }
+
+	T load() const {
+		uint64_t buffer[WORD_COUNT];
+		uint32_t before, after;
+		do {
+			before = sequence.load(std::memory_order_acquire);
+			while (before & 1) {
+				before = sequence.load(std::memory_order_acquire);
+			}
+			for (size_t i = 0; i < WORD_COUNT; ++i) {
+				buffer[i] = words[i].load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = sequence.load(std::memory_order_relaxed);
+		} while (before != after);
+		T value;
+		std::memcpy(&value, buffer, sizeof(T));
+		return value;
+	}
+
+	void store(const T &p_value) {
+		uint64_t buffer[WORD_COUNT] = {};
+		std::memcpy(buffer, &p_value, sizeof(T));
+		write_lock.lock();
+		const uint32_t current = sequence.load(std::memory_order_relaxed);
+		sequence.store(current + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t i = 0; i < WORD_COUNT; ++i) {
+			words[i].store(buffer[i], std::memory_order_relaxed);
+		}
+		sequence.store(current + 2, std::memory_order_release);
+		write_lock.unlock();
+	}
+
+private:
+	std::atomic<uint32_t> sequence{ 0 };
+	std::atomic<uint64_t> words[WORD_COUNT];
+	SpinLock write_lock;
+};
+
+// Pair of values, one published for the readers while the other one is rewritten.
+// Readers pin the published value for as long as they hold it, and never wait. Before rewriting the other
+// value, a writer waits for the readers that pinned it before the last publication. Writers are serialized.
+// Meant for large values, rarely written and read by many threads at once.
+template <typename T>
+class NoiseDoubleBuffer {
+public:
+	class Reader {
+	public:
+		Reader(const Reader &) = delete;
+		Reader &operator=(const Reader &) = delete;
+		~Reader() { buffer->readers[index].fetch_sub(1, std::memory_order_release); }
+
+		const T &operator*() const { return buffer->values[index]; }
+		const T *operator->() const { return &buffer->values[index]; }
+
+	private:
+		friend class NoiseDoubleBuffer;
+		Reader(const NoiseDoubleBuffer *p_buffer, int p_index) :
+				buffer(p_buffer), index(p_index) {}
+
+		const NoiseDoubleBuffer *buffer;
+		int index;
+	};
+
+	Reader read() const {
+		for (;;) {
+			const int index = published.load();
+			readers[index].fetch_add(1);
+			// The value may have been unpublished and handed to a writer before it got pinned.
+			if (published.load() == index) {
+				return Reader(this, index);
+			}
+			readers[index].fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	// Rewrites the unpublished value with the given function, then publishes it.
+	template <typename F>
+	void write(const F &p_write) {
+		write_lock.lock();
+		const int index = 1 - published.load(std::memory_order_relaxed);
+		while (readers[index].load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+		p_write(values[index]);
+		published.store(index);
+		write_lock.unlock();
+	}
+
+	// Rewrites the unpublished value with the given function once its readers are done, without publishing
+	// it. Lets the previous value be released.
+	template <typename F>
+	void write_unpublished(const F &p_write) {
+		write_lock.lock();
+		const int index = 1 - published.load(std::memory_order_relaxed);
+		while (readers[index].load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+		p_write(values[index]);
+		write_lock.unlock();
+	}
+
+private:
+	T values[2];
+	std::atomic<int> published{ 0 };
+	mutable std::atomic<uint32_t> readers[2] = { { 0 }, { 0 } };
+	SpinLock write_lock;
+};
+
+#endif
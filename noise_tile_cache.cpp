@@ -0,0 +1,663 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_tile_cache.h"
+
+#include "core/math/math_funcs.h"
+#include "core/templates/hash_set.h"
+#include "noise_baked.h"
+#include "noise_composer.h"
+#include <cstring>
+
+uint32_t NoiseTileCache::TilePool::allocate() {
+	if (free_slots.is_empty()) {
+		uint32_t page = 0;
+		while (page < pages.size() && pages[page]) {
+			++page;
+		}
+		if (page == pages.size()) {
+			pages.push_back(nullptr);
+			page_usage.push_back(0);
+		}
+		pages[page] = (float *)memalloc(page_slots * slot_size * sizeof(float));
+		++page_count;
+		for (uint32_t i = page_slots; i > 0; --i) {
+			free_slots.push_back((page * page_slots) + i - 1);
+		}
+	}
+	const uint32_t slot = free_slots[free_slots.size() - 1];
+	free_slots.resize(free_slots.size() - 1);
+	++page_usage[slot / page_slots];
+	return slot;
+}
+
+void NoiseTileCache::TilePool::release(uint32_t p_slot) {
+	const uint32_t page = p_slot / page_slots;
+	if (--page_usage[page] > 0) {
+		free_slots.push_back(p_slot);
+		return;
+	}
+	memfree(pages[page]);
+	pages[page] = nullptr;
+	--page_count;
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < free_slots.size(); ++i) {
+		if (free_slots[i] / page_slots != page) {
+			free_slots[kept++] = free_slots[i];
+		}
+	}
+	free_slots.resize(kept);
+}
+
+void NoiseTileCache::TilePool::reset(uint32_t p_slot_size, uint32_t p_page_slots) {
+	for (float *page : pages) {
+		if (page) {
+			memfree(page);
+		}
+	}
+	pages.clear();
+	page_usage.clear();
+	page_count = 0;
+	free_slots.clear();
+	slot_size = p_slot_size;
+	page_slots = CLAMP(p_page_slots, 1u, PAGE_SLOTS);
+}
+
+NoiseTileCache::~NoiseTileCache() {
+	if (source.is_valid()) {
+		source->disconnect_changed(callable_mp(this, &NoiseTileCache::_changed));
+	}
+	RWLockWrite index(index_lock);
+	_clear();
+	pool_2d.reset(0, 1);
+	pool_3d.reset(0, 1);
+	store.close();
+}
+
+void NoiseTileCache::set_source(Ref<Noise> n) {
+	if (source.is_valid()) {
+		source->disconnect_changed(callable_mp(this, &NoiseTileCache::_changed));
+	}
+	source = n;
+	if (source.is_valid()) {
+		source->connect_changed(callable_mp(this, &NoiseTileCache::_changed));
+	}
+	_changed();
+}
+
+void NoiseTileCache::set_tile_size_2d(int p_size) {
+	ERR_FAIL_COND(p_size <= 0);
+	MutexLock lock(mutex);
+	{
+		RWLockWrite index(index_lock);
+		tile_size_2d = p_size;
+		_clear();
+	}
+	_open_store();
+	loaded.notify_all();
+}
+
+void NoiseTileCache::set_tile_size_3d(int p_size) {
+	ERR_FAIL_COND(p_size <= 0);
+	MutexLock lock(mutex);
+	{
+		RWLockWrite index(index_lock);
+		tile_size_3d = p_size;
+		_clear();
+	}
+	_open_store();
+	loaded.notify_all();
+}
+
+int NoiseTileCache::get_tile_size_2d() const {
+	MutexLock lock(mutex);
+	return tile_size_2d;
+}
+
+int NoiseTileCache::get_tile_size_3d() const {
+	MutexLock lock(mutex);
+	return tile_size_3d;
+}
+
+void NoiseTileCache::set_memory_budget(int64_t p_bytes) {
+	MutexLock lock(mutex);
+	RWLockWrite index(index_lock);
+	memory_budget = MAX(0, p_bytes);
+	_evict(0);
+	_fit_pages();
+}
+
+void NoiseTileCache::set_store_path(const String &p_path) {
+	MutexLock lock(mutex);
+	store_path = p_path;
+	_open_store();
+}
+
+void NoiseTileCache::set_store_format(StoreFormat p_format) {
+	MutexLock lock(mutex);
+	store_format = p_format;
+	_open_store();
+}
+
+void NoiseTileCache::get_tile_2d(const Vector2i &p_tile, int p_lod, float *r_values) {
+	ERR_FAIL_INDEX(p_lod, MAX_LOD + 1);
+	NoiseTileKey key;
+	key.x = p_tile.x;
+	key.y = p_tile.y;
+	key.lod = p_lod;
+	ERR_FAIL_COND_MSG(!_get_tile(key, get_tile_size_2d(), r_values), "The tile size changed during the request.");
+}
+
+void NoiseTileCache::get_tile_3d(const Vector3i &p_tile, int p_lod, float *r_values) {
+	ERR_FAIL_INDEX(p_lod, MAX_LOD + 1);
+	NoiseTileKey key;
+	key.x = p_tile.x;
+	key.y = p_tile.y;
+	key.z = p_tile.z;
+	key.lod = p_lod;
+	key.volume = true;
+	ERR_FAIL_COND_MSG(!_get_tile(key, get_tile_size_3d(), r_values), "The tile size changed during the request.");
+}
+
+// Sized again and retried when the tile size changes meanwhile.
+PackedFloat32Array NoiseTileCache::_get_tile_2d(const Vector2i &p_tile, int p_lod) {
+	ERR_FAIL_INDEX_V(p_lod, MAX_LOD + 1, PackedFloat32Array());
+	NoiseTileKey key;
+	key.x = p_tile.x;
+	key.y = p_tile.y;
+	key.lod = p_lod;
+	PackedFloat32Array result;
+	for (;;) {
+		const int size = get_tile_size_2d();
+		result.resize(size * size);
+		if (_get_tile(key, size, result.ptrw())) {
+			return result;
+		}
+	}
+}
+
+PackedFloat32Array NoiseTileCache::_get_tile_3d(const Vector3i &p_tile, int p_lod) {
+	ERR_FAIL_INDEX_V(p_lod, MAX_LOD + 1, PackedFloat32Array());
+	NoiseTileKey key;
+	key.x = p_tile.x;
+	key.y = p_tile.y;
+	key.z = p_tile.z;
+	key.lod = p_lod;
+	key.volume = true;
+	PackedFloat32Array result;
+	for (;;) {
+		const int size = get_tile_size_3d();
+		result.resize(size * size * size);
+		if (_get_tile(key, size, result.ptrw())) {
+			return result;
+		}
+	}
+}
+
+void NoiseTileCache::clear() {
+	MutexLock lock(mutex);
+	{
+		RWLockWrite index(index_lock);
+		_clear();
+	}
+	loaded.notify_all();
+}
+
+int64_t NoiseTileCache::get_memory_usage() const {
+	MutexLock lock(mutex);
+	return _get_memory_usage();
+}
+
+int NoiseTileCache::get_resident_tile_count() const {
+	MutexLock lock(mutex);
+	int count = 0;
+	for (const Tile *tile = most_recent; tile; tile = tile->next) {
+		++count;
+	}
+	return count;
+}
+
+int64_t NoiseTileCache::get_tile_hits() const {
+	MutexLock lock(mutex);
+	return hits;
+}
+
+int64_t NoiseTileCache::get_tile_misses() const {
+	MutexLock lock(mutex);
+	return misses;
+}
+
+bool NoiseTileCache::_get_tile(const NoiseTileKey &p_key, int p_size, float *r_values) {
+	NOISE_PROFILE_SCOPE(p_key.volume ? p_size * p_size * p_size : p_size * p_size);
+	uint64_t tile_generation = 0;
+	{
+		MutexLock lock(mutex);
+		for (Tile **found = tiles.getptr(p_key); found; found = tiles.getptr(p_key)) {
+			if (p_size != (p_key.volume ? tile_size_3d : tile_size_2d)) {
+				return false;
+			}
+			Tile *tile = *found;
+			if (tile->ready) {
+				++hits;
+				NOISE_PROFILE_CACHE(1, 0);
+				_touch(tile);
+				const TilePool &pool = _get_pool(p_key.volume);
+				memcpy(r_values, pool.get(tile->slot), pool.get_slot_bytes());
+				return true;
+			}
+			// Sampled by another request.
+			loaded.wait(lock);
+		}
+		if (p_size != (p_key.volume ? tile_size_3d : tile_size_2d)) {
+			return false;
+		}
+		++misses;
+		NOISE_PROFILE_CACHE(0, 1);
+		Tile *tile = memnew(Tile);
+		tile->key = p_key;
+		RWLockWrite index(index_lock);
+		tiles.insert(p_key, tile);
+		tile_generation = generation;
+	}
+
+	const bool stored = store.load(p_key, p_size, r_values);
+	// Values sampled while the source is working are only valid until it is done.
+	bool storable = false;
+	if (!stored) {
+		storable = store.is_open() && !_is_source_working();
+		_sample_tile(p_key, p_size, r_values);
+		storable = storable && !_is_source_working();
+	}
+
+	MutexLock lock(mutex);
+	Tile **found = tiles.getptr(p_key);
+	// After a clear, the tile is not ours anymore, and its values may be stale.
+	if (found && generation == tile_generation) {
+		Tile *tile = *found;
+		if (storable) {
+			store.store(p_key, r_values);
+		}
+		RWLockWrite index(index_lock);
+		TilePool &pool = _get_pool(p_key.volume);
+		if (_reserve(pool)) {
+			tile->slot = pool.allocate();
+			memcpy(pool.get(tile->slot), r_values, pool.get_slot_bytes());
+			tile->ready = true;
+			_touch(tile);
+		} else {
+			tiles.erase(p_key);
+			memdelete(tile);
+		}
+	}
+	loaded.notify_all();
+	return true;
+}
+
+bool NoiseTileCache::_is_source_working() const {
+	HashSet<const Noise *> checked;
+	LocalVector<Ref<Noise>> to_check;
+	to_check.push_back(source);
+	while (!to_check.is_empty()) {
+		const Ref<Noise> noise = to_check[to_check.size() - 1];
+		to_check.resize(to_check.size() - 1);
+		if (noise.is_null() || checked.has(noise.ptr())) {
+			continue;
+		}
+		checked.insert(noise.ptr());
+		const BakedNoise *baked = Object::cast_to<BakedNoise>(noise.ptr());
+		const RescalerNoise *rescaler = Object::cast_to<RescalerNoise>(noise.ptr());
+		if ((baked && baked->is_working()) || (rescaler && rescaler->is_working())) {
+			return true;
+		}
+		const NoiseNode *node = Object::cast_to<NoiseNode>(noise.ptr());
+		if (node) {
+			for (int i = 0; i < node->get_child_count(); ++i) {
+				to_check.push_back(node->get_child(i));
+			}
+		}
+	}
+	return false;
+}
+
+void NoiseTileCache::_sample_tile(const NoiseTileKey &p_key, int p_size, float *r_values) const {
+	const real_t spacing = real_t(1 << p_key.lod);
+	const NoiseNode *node = Object::cast_to<NoiseNode>(source.ptr());
+	LocalVector<real_t> values;
+	if (p_key.volume) {
+		const int size = p_size;
+		const Vector3 origin = Vector3(p_key.x, p_key.y, p_key.z) * (size * spacing);
+		LocalVector<Vector3> points;
+		points.resize(size * size * size);
+		values.resize(points.size());
+		for (int k = 0; k < size; ++k) {
+			for (int j = 0; j < size; ++j) {
+				for (int i = 0; i < size; ++i) {
+					points[(((k * size) + j) * size) + i] = origin + (Vector3(i, j, k) * spacing);
+				}
+			}
+		}
+		if (node) {
+			const real_t extent = (size - 1) * spacing;
+			node->get_noise_3d_region_batch(AABB(origin, Vector3(extent, extent, extent)), points.ptr(), values.ptr(), points.size());
+		} else {
+			sample_batch(source, points.ptr(), values.ptr(), points.size());
+		}
+	} else {
+		const int size = p_size;
+		const Vector2 origin = Vector2(p_key.x, p_key.y) * (size * spacing);
+		LocalVector<Vector2> points;
+		points.resize(size * size);
+		values.resize(points.size());
+		for (int j = 0; j < size; ++j) {
+			for (int i = 0; i < size; ++i) {
+				points[(j * size) + i] = origin + (Vector2(i, j) * spacing);
+			}
+		}
+		if (node) {
+			const real_t extent = (size - 1) * spacing;
+			node->get_noise_2d_region_batch(Rect2(origin, Vector2(extent, extent)), points.ptr(), values.ptr(), points.size());
+		} else {
+			sample_batch(source, points.ptr(), values.ptr(), points.size());
+		}
+	}
+	for (uint32_t i = 0; i < values.size(); ++i) {
+		r_values[i] = values[i];
+	}
+}
+
+// Rounds towards negative infinity, exactly for any index.
+static inline int64_t _floor_divide(int64_t p_index, int64_t p_size) {
+	int64_t quotient = p_index / p_size;
+	if ((p_index % p_size) < 0) {
+		--quotient;
+	}
+	return quotient;
+}
+
+bool NoiseTileCache::_is_lattice_point(const Vector3 &p_point, bool p_volume) {
+	for (int axis = 0; axis < (p_volume ? 3 : 2); ++axis) {
+		if (Math::floor(p_point[axis]) != p_point[axis]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool NoiseTileCache::_find_value(const Vector3 &p_point, bool p_volume, real_t &r_value) const {
+	static constexpr real_t LIMIT = real_t(1 << 30);
+	const int size = p_volume ? tile_size_3d : tile_size_2d;
+	const int axes = p_volume ? 3 : 2;
+	// A point off the lattice of a level is also off the lattices of the coarser levels.
+	for (int lod = 0; lod <= MAX_LOD; ++lod) {
+		const real_t spacing = real_t(1 << lod);
+		int64_t index[3] = { 0, 0, 0 };
+		for (int axis = 0; axis < axes; ++axis) {
+			const real_t scaled = p_point[axis] / spacing;
+			if (Math::floor(scaled) != scaled || Math::abs(scaled) > LIMIT) {
+				return false;
+			}
+			index[axis] = int64_t(scaled);
+		}
+		NoiseTileKey key;
+		key.x = _floor_divide(index[0], size);
+		key.y = _floor_divide(index[1], size);
+		key.z = p_volume ? _floor_divide(index[2], size) : 0;
+		key.lod = lod;
+		key.volume = p_volume;
+		Tile *const *found = tiles.getptr(key);
+		if (found && (*found)->ready) {
+			const int64_t i = index[0] - (int64_t(key.x) * size);
+			const int64_t j = index[1] - (int64_t(key.y) * size);
+			const int64_t k = index[2] - (int64_t(key.z) * size);
+			const float *values = (p_volume ? pool_3d : pool_2d).get((*found)->slot);
+			r_value = values[(((k * size) + j) * size) + i];
+			return true;
+		}
+	}
+	return false;
+}
+
+void NoiseTileCache::_touch(Tile *p_tile) {
+	_unlink(p_tile);
+	p_tile->next = most_recent;
+	if (most_recent) {
+		most_recent->previous = p_tile;
+	}
+	most_recent = p_tile;
+	if (!least_recent) {
+		least_recent = p_tile;
+	}
+}
+
+void NoiseTileCache::_unlink(Tile *p_tile) {
+	if (p_tile->previous) {
+		p_tile->previous->next = p_tile->next;
+	} else if (most_recent == p_tile) {
+		most_recent = p_tile->next;
+	}
+	if (p_tile->next) {
+		p_tile->next->previous = p_tile->previous;
+	} else if (least_recent == p_tile) {
+		least_recent = p_tile->previous;
+	}
+	p_tile->previous = nullptr;
+	p_tile->next = nullptr;
+}
+
+void NoiseTileCache::_evict(int64_t p_needed) {
+	while (least_recent && _get_memory_usage() + p_needed > memory_budget) {
+		_evict_least_recent();
+	}
+}
+
+void NoiseTileCache::_evict_least_recent() {
+	Tile *tile = least_recent;
+	_unlink(tile);
+	_get_pool(tile->key.volume).release(tile->slot);
+	tiles.erase(tile->key);
+	memdelete(tile);
+}
+
+// A tile takes a new page when no slot is free, and evicting others may free one.
+bool NoiseTileCache::_reserve(TilePool &p_pool) {
+	for (;;) {
+		const int64_t needed = p_pool.has_free_slot() ? 0 : p_pool.get_page_bytes();
+		if (_get_memory_usage() + needed <= memory_budget) {
+			return true;
+		}
+		if (!least_recent) {
+			return false;
+		}
+		_evict_least_recent();
+	}
+}
+
+void NoiseTileCache::_clear() {
+	for (const KeyValue<NoiseTileKey, Tile *> &E : tiles) {
+		memdelete(E.value);
+	}
+	tiles.clear();
+	most_recent = nullptr;
+	least_recent = nullptr;
+	pool_2d.reset(0, 1);
+	pool_3d.reset(0, 1);
+	_fit_pages();
+	++generation;
+}
+
+// Pages hold fewer tiles when the budget would not hold a full one. Only empty pools change.
+void NoiseTileCache::_fit_pages() {
+	const uint32_t count_2d = tile_size_2d * tile_size_2d;
+	const uint32_t count_3d = tile_size_3d * tile_size_3d * tile_size_3d;
+	if (pool_2d.page_count == 0) {
+		pool_2d.reset(count_2d, uint32_t(MIN(memory_budget / (count_2d * sizeof(float)), int64_t(TilePool::PAGE_SLOTS))));
+	}
+	if (pool_3d.page_count == 0) {
+		pool_3d.reset(count_3d, uint32_t(MIN(memory_budget / (count_3d * sizeof(float)), int64_t(TilePool::PAGE_SLOTS))));
+	}
+}
+
+void NoiseTileCache::_open_store() {
+	if (source.is_null() || store_path.is_empty()) {
+		store.close();
+		return;
+	}
+	store.open(store_path, get_structure_hash(source), tile_size_2d, tile_size_3d, NoiseTileStore::Format(store_format));
+}
+
+void NoiseTileCache::_changed() {
+	{
+		// Reopened along with the clear, so that no tile sampled from the previous source gets stored. The
+		// structure may be the same, in which case the tiles not flushed yet may come from a transient state.
+		MutexLock lock(mutex);
+		{
+			RWLockWrite index(index_lock);
+			_clear();
+		}
+		_open_store();
+		store.drop_pending();
+		loaded.notify_all();
+	}
+	_notify_changed();
+}
+
+real_t NoiseTileCache::get_noise_1d(real_t p_x) const {
+	NOISE_PROFILE_SCOPE(1);
+	return source.is_valid() ? source->get_noise_1d(p_x) : 0.;
+}
+
+real_t NoiseTileCache::get_noise_2dv(Vector2 p_v) const {
+	return get_noise_2d(p_v.x, p_v.y);
+}
+real_t NoiseTileCache::get_noise_2d(real_t p_x, real_t p_y) const {
+	NOISE_PROFILE_SCOPE(1);
+	real_t value = 0.;
+	if (_is_lattice_point(Vector3(p_x, p_y, 0.), false)) {
+		RWLockRead index(index_lock);
+		if (_find_value(Vector3(p_x, p_y, 0.), false, value)) {
+			return value;
+		}
+	}
+	return source.is_valid() ? source->get_noise_2d(p_x, p_y) : 0.;
+}
+
+real_t NoiseTileCache::get_noise_3dv(Vector3 p_v) const {
+	return get_noise_3d(p_v.x, p_v.y, p_v.z);
+}
+real_t NoiseTileCache::get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const {
+	NOISE_PROFILE_SCOPE(1);
+	real_t value = 0.;
+	if (_is_lattice_point(Vector3(p_x, p_y, p_z), true)) {
+		RWLockRead index(index_lock);
+		if (_find_value(Vector3(p_x, p_y, p_z), true, value)) {
+			return value;
+		}
+	}
+	return source.is_valid() ? source->get_noise_3d(p_x, p_y, p_z) : 0.;
+}
+
+// Points missing from the resident tiles are gathered and sampled from the source.
+template <typename P>
+static void _sample_missing(const Ref<Noise> &p_source, const P *p_points, const LocalVector<int> &p_missing, real_t *r_values) {
+	P points[NoiseNode::BATCH_SIZE];
+	real_t values[NoiseNode::BATCH_SIZE];
+	for (uint32_t offset = 0; offset < p_missing.size(); offset += NoiseNode::BATCH_SIZE) {
+		const int block = MIN(NoiseNode::BATCH_SIZE, int(p_missing.size() - offset));
+		for (int i = 0; i < block; ++i) {
+			points[i] = p_points[p_missing[offset + i]];
+		}
+		NoiseNode::sample_batch(p_source, points, values, block);
+		for (int i = 0; i < block; ++i) {
+			r_values[p_missing[offset + i]] = values[i];
+		}
+	}
+}
+
+void NoiseTileCache::get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	LocalVector<int> missing;
+	{
+		RWLockRead index(index_lock);
+		for (int i = 0; i < p_count; ++i) {
+			if (!_find_value(Vector3(p_v[i].x, p_v[i].y, 0.), false, r_values[i])) {
+				missing.push_back(i);
+			}
+		}
+	}
+	_sample_missing(source, p_v, missing, r_values);
+}
+
+void NoiseTileCache::get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const {
+	NOISE_PROFILE_SCOPE(p_count);
+	LocalVector<int> missing;
+	{
+		RWLockRead index(index_lock);
+		for (int i = 0; i < p_count; ++i) {
+			if (!_find_value(p_v[i], true, r_values[i])) {
+				missing.push_back(i);
+			}
+		}
+	}
+	_sample_missing(source, p_v, missing, r_values);
+}
+
+void NoiseTileCache::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_source", "n"), &NoiseTileCache::set_source);
+	ClassDB::bind_method(D_METHOD("get_source"), &NoiseTileCache::get_source);
+
+	ClassDB::bind_method(D_METHOD("set_tile_size_2d", "size"), &NoiseTileCache::set_tile_size_2d);
+	ClassDB::bind_method(D_METHOD("get_tile_size_2d"), &NoiseTileCache::get_tile_size_2d);
+
+	ClassDB::bind_method(D_METHOD("set_tile_size_3d", "size"), &NoiseTileCache::set_tile_size_3d);
+	ClassDB::bind_method(D_METHOD("get_tile_size_3d"), &NoiseTileCache::get_tile_size_3d);
+
+	ClassDB::bind_method(D_METHOD("set_memory_budget", "bytes"), &NoiseTileCache::set_memory_budget);
+	ClassDB::bind_method(D_METHOD("get_memory_budget"), &NoiseTileCache::get_memory_budget);
+
+	ClassDB::bind_method(D_METHOD("set_store_path", "path"), &NoiseTileCache::set_store_path);
+	ClassDB::bind_method(D_METHOD("get_store_path"), &NoiseTileCache::get_store_path);
+
+	ClassDB::bind_method(D_METHOD("set_store_format", "format"), &NoiseTileCache::set_store_format);
+	ClassDB::bind_method(D_METHOD("get_store_format"), &NoiseTileCache::get_store_format);
+
+	ClassDB::bind_method(D_METHOD("flush_store"), &NoiseTileCache::flush_store);
+
+	ClassDB::bind_method(D_METHOD("get_tile_2d", "tile", "lod"), &NoiseTileCache::_get_tile_2d, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("get_tile_3d", "tile", "lod"), &NoiseTileCache::_get_tile_3d, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("clear"), &NoiseTileCache::clear);
+
+	ClassDB::bind_method(D_METHOD("get_memory_usage"), &NoiseTileCache::get_memory_usage);
+	ClassDB::bind_method(D_METHOD("get_resident_tile_count"), &NoiseTileCache::get_resident_tile_count);
+	ClassDB::bind_method(D_METHOD("get_tile_hits"), &NoiseTileCache::get_tile_hits);
+	ClassDB::bind_method(D_METHOD("get_tile_misses"), &NoiseTileCache::get_tile_misses);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "source", PROPERTY_HINT_RESOURCE_TYPE, "Noise"), "set_source", "get_source");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_size_2d", PROPERTY_HINT_RANGE, "1,1024,1"), "set_tile_size_2d", "get_tile_size_2d");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_size_3d", PROPERTY_HINT_RANGE, "1,256,1"), "set_tile_size_3d", "get_tile_size_3d");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "memory_budget", PROPERTY_HINT_RANGE, "0,4294967296,1,suffix:B"), "set_memory_budget", "get_memory_budget");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "store_path", PROPERTY_HINT_FILE, "*.ncts"), "set_store_path", "get_store_path");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "store_format", PROPERTY_HINT_ENUM, "Float32,Float16"), "set_store_format", "get_store_format");
+
+	BIND_ENUM_CONSTANT(STORE_FORMAT_FLOAT32);
+	BIND_ENUM_CONSTANT(STORE_FORMAT_FLOAT16);
+}
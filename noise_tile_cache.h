@@ -0,0 +1,206 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_TILE_CACHE_H
+#define NOISE_TILE_CACHE_H
+
+#include "core/os/condition_variable.h"
+#include "core/os/mutex.h"
+#include "core/os/rw_lock.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "noise_base.h"
+#include "noise_tile_store.h"
+
+// Noise serving square (2D) or cubic (3D) tiles of its source, sampled over a lattice whose spacing doubles
+// with each level of detail. Tiles are kept in memory as 32 bits floats, within a memory budget and evicted
+// least recently used first. Memory is counted by whole pages of tiles, up to TilePool::PAGE_SLOTS tiles each
+// and fewer when the budget is small, and a page is freed once its tiles are all evicted. A tile requested by
+// several threads at once is sampled once. Point queries falling on the lattice of a resident tile are
+// answered from it, any other query is answered by the source. With a store path, sampled tiles are also
+// persisted, and reused by later runs as long as the structure hash of the source is unchanged. Tiles loaded
+// from a float16 store keep its precision, so their lattice points may differ from the source, and from
+// queries off the lattice, by up to 1/2048 of their magnitude.
+class NoiseTileCache : public NoiseNode {
+	GDCLASS(NoiseTileCache, NoiseNode)
+	OBJ_SAVE_TYPE(NoiseTileCache)
+
+public:
+	// Deepest level of detail, whose lattice spacing is 2^MAX_LOD.
+	static constexpr int MAX_LOD = 16;
+
+	// Format of the stored values, see NoiseTileStore::Format.
+	enum StoreFormat {
+		STORE_FORMAT_FLOAT32 = NoiseTileStore::FORMAT_FLOAT32,
+		STORE_FORMAT_FLOAT16 = NoiseTileStore::FORMAT_FLOAT16,
+	};
+
+public:
+	NoiseTileCache() :
+			NoiseNode(1) {}
+	virtual ~NoiseTileCache();
+
+	void set_source(Ref<Noise> n);
+	Ref<Noise> get_source() const { return source; }
+
+	void set_tile_size_2d(int p_size);
+	int get_tile_size_2d() const;
+
+	void set_tile_size_3d(int p_size);
+	int get_tile_size_3d() const;
+
+	void set_memory_budget(int64_t p_bytes);
+	int64_t get_memory_budget() const { return memory_budget; }
+
+	void set_store_path(const String &p_path);
+	String get_store_path() const { return store_path; }
+
+	void set_store_format(StoreFormat p_format);
+	StoreFormat get_store_format() const { return store_format; }
+
+	// Writes the tiles sampled since the last flush to the store.
+	Error flush_store() { return store.flush(); }
+
+	// Values of a tile, row by row, then layer by layer. The tile at (x, y) of level p_lod covers the points
+	// (x * size + i) * 2^p_lod, for i from 0 to size - 1 along each axis.
+	void get_tile_2d(const Vector2i &p_tile, int p_lod, float *r_values);
+	void get_tile_3d(const Vector3i &p_tile, int p_lod, float *r_values);
+
+	PackedFloat32Array _get_tile_2d(const Vector2i &p_tile, int p_lod);
+	PackedFloat32Array _get_tile_3d(const Vector3i &p_tile, int p_lod);
+
+	void clear();
+
+	int64_t get_memory_usage() const;
+	int get_resident_tile_count() const;
+	int64_t get_tile_hits() const;
+	int64_t get_tile_misses() const;
+
+	virtual real_t get_noise_1d(real_t p_x) const override;
+
+	virtual real_t get_noise_2dv(Vector2 p_v) const override;
+	virtual real_t get_noise_2d(real_t p_x, real_t p_y) const override;
+
+	virtual real_t get_noise_3dv(Vector3 p_v) const override;
+	virtual real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override;
+
+	virtual void get_noise_2d_batch(const Vector2 *p_v, real_t *r_values, int p_count) const override;
+	virtual void get_noise_3d_batch(const Vector3 *p_v, real_t *r_values, int p_count) const override;
+
+	// Gradient of the source, at the point.
+	virtual real_t get_noise_2d_gradient(const Vector2 &p_v, Vector2 &r_gradient) const override { return get_gradient(source, p_v, r_gradient); }
+	virtual real_t get_noise_3d_gradient(const Vector3 &p_v, Vector3 &r_gradient) const override { return get_gradient(source, p_v, r_gradient); }
+
+	virtual Ref<Noise> get_child(int) const override { return source; }
+
+	virtual NoiseInterval get_region_interval(const NoiseRegion &p_region, bool p_strict = false) const override { return get_interval(source, p_region, p_strict); }
+
+protected:
+	static void _bind_methods();
+
+	void _changed();
+
+private:
+	struct Tile {
+		NoiseTileKey key;
+		uint32_t slot{ 0 };
+		// Tiles are inserted before being sampled, the requests made meanwhile wait for them.
+		bool ready{ false };
+		// Least recently used list of the ready tiles, most recent first.
+		Tile *previous{ nullptr };
+		Tile *next{ nullptr };
+	};
+
+	// Storage of the tiles of one size, in pages of contiguous slots reused once freed. Pages whose slots are
+	// all free are released.
+	struct TilePool {
+		static constexpr uint32_t PAGE_SLOTS = 16;
+
+		uint32_t slot_size{ 0 };
+		uint32_t page_slots{ PAGE_SLOTS };
+		// Released pages are null, and reallocated first.
+		LocalVector<float *> pages;
+		LocalVector<uint32_t> page_usage;
+		uint32_t page_count{ 0 };
+		LocalVector<uint32_t> free_slots;
+
+		uint32_t allocate();
+		void release(uint32_t p_slot);
+		float *get(uint32_t p_slot) const { return pages[p_slot / page_slots] + ((p_slot % page_slots) * slot_size); }
+		bool has_free_slot() const { return !free_slots.is_empty(); }
+		int64_t get_slot_bytes() const { return int64_t(slot_size) * sizeof(float); }
+		int64_t get_page_bytes() const { return get_slot_bytes() * page_slots; }
+		int64_t get_resident_bytes() const { return get_page_bytes() * page_count; }
+		void reset(uint32_t p_slot_size, uint32_t p_page_slots);
+	};
+
+	// Fails when the tiles are no longer p_size values wide.
+	bool _get_tile(const NoiseTileKey &p_key, int p_size, float *r_values);
+	void _sample_tile(const NoiseTileKey &p_key, int p_size, float *r_values) const;
+	// Whether a node of the source is still computing what its values depend on.
+	bool _is_source_working() const;
+	// Whether the point is on the finest lattice, off which no tile can hold its value.
+	static bool _is_lattice_point(const Vector3 &p_point, bool p_volume);
+	// Value at a lattice point of a resident tile, false when there is none. Needs the index lock.
+	bool _find_value(const Vector3 &p_point, bool p_volume, real_t &r_value) const;
+	TilePool &_get_pool(bool p_volume) { return p_volume ? pool_3d : pool_2d; }
+	int64_t _get_memory_usage() const { return pool_2d.get_resident_bytes() + pool_3d.get_resident_bytes(); }
+	void _touch(Tile *p_tile);
+	void _unlink(Tile *p_tile);
+	// Need the mutex and the index lock for writing.
+	void _evict(int64_t p_needed);
+	void _evict_least_recent();
+	// Makes room for a tile in the pool, false when the budget cannot hold it.
+	bool _reserve(TilePool &p_pool);
+	void _clear();
+	void _fit_pages();
+	void _open_store();
+
+private:
+	Ref<Noise> source;
+	int tile_size_2d{ 64 };
+	int tile_size_3d{ 32 };
+	int64_t memory_budget{ 64 * 1024 * 1024 };
+	String store_path;
+	StoreFormat store_format{ STORE_FORMAT_FLOAT32 };
+	NoiseTileStore store;
+
+	mutable BinaryMutex mutex;
+	ConditionVariable loaded;
+	// Point queries only take this lock, for reading. The tiles, their values, the pools and the tile sizes
+	// change with the mutex held and this lock taken for writing.
+	mutable RWLock index_lock;
+	HashMap<NoiseTileKey, Tile *, NoiseTileKeyHasher> tiles;
+	TilePool pool_2d;
+	TilePool pool_3d;
+	Tile *most_recent{ nullptr };
+	Tile *least_recent{ nullptr };
+	// Bumped by every clear, tiles sampled from an older source are dropped.
+	uint64_t generation{ 0 };
+	mutable int64_t hits{ 0 };
+	mutable int64_t misses{ 0 };
+};
+
+VARIANT_ENUM_CAST(NoiseTileCache::StoreFormat);
+
+#endif
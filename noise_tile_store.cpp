@@ -0,0 +1,344 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_tile_store.h"
+
+#include "core/config/project_settings.h"
+#include "core/io/dir_access.h"
+#include "core/math/math_funcs.h"
+#include "core/templates/hashfuncs.h"
+#include <cstring>
+
+#ifdef UNIX_ENABLED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+uint32_t NoiseTileKeyHasher::hash(const NoiseTileKey &p_key) {
+	uint32_t hash = hash_murmur3_one_32(p_key.x);
+	hash = hash_murmur3_one_32(p_key.y, hash);
+	hash = hash_murmur3_one_32(p_key.z, hash);
+	hash = hash_murmur3_one_32((p_key.lod << 1) | (p_key.volume ? 1 : 0), hash);
+	return hash_fmix32(hash);
+}
+
+void NoiseTileStore::open(const String &p_path, uint64_t p_hash, uint32_t p_tile_size_2d, uint32_t p_tile_size_3d, Format p_format) {
+	MutexLock lock(mutex);
+	if (p_path == path && p_hash == hash && p_tile_size_2d == tile_size_2d && p_tile_size_3d == tile_size_3d && p_format == format) {
+		return;
+	}
+	if (p_path != path) {
+		flush();
+	}
+	_reset();
+	path = p_path;
+	hash = p_hash;
+	tile_size_2d = p_tile_size_2d;
+	tile_size_3d = p_tile_size_3d;
+	format = p_format;
+	if (!path.is_empty()) {
+		_read_index();
+		_map();
+	}
+}
+
+void NoiseTileStore::close() {
+	MutexLock lock(mutex);
+	flush();
+	_reset();
+	path = String();
+}
+
+void NoiseTileStore::drop_pending() {
+	MutexLock lock(mutex);
+	pending.clear();
+}
+
+Error NoiseTileStore::flush() {
+	MutexLock lock(mutex);
+	if (pending.is_empty() || path.is_empty()) {
+		return OK;
+	}
+	// Every flush leaves the previous index behind.
+	if (file_size > 2 * _get_live_size()) {
+		return _compact();
+	}
+	_unmap();
+	const bool append = file_size > 0;
+	Error error = OK;
+	Ref<FileAccess> file = FileAccess::open(path, append ? FileAccess::READ_WRITE : FileAccess::WRITE, &error);
+	ERR_FAIL_COND_V_MSG(file.is_null(), error, vformat("Cannot write the noise tile store '%s'.", path));
+
+	uint64_t position = file_size;
+	if (!append) {
+		const uint8_t header[HEADER_SIZE] = {};
+		file->store_buffer(header, HEADER_SIZE);
+		position = HEADER_SIZE;
+	}
+	_append(file, position);
+	file->close();
+	_map();
+	return OK;
+}
+
+static uint64_t _align_payload(uint64_t p_position) {
+	return ((p_position + NoiseTileStore::PAYLOAD_ALIGNMENT - 1) / NoiseTileStore::PAYLOAD_ALIGNMENT) * NoiseTileStore::PAYLOAD_ALIGNMENT;
+}
+
+uint64_t NoiseTileStore::_get_live_size() const {
+	uint64_t size = HEADER_SIZE;
+	for (const KeyValue<NoiseTileKey, uint64_t> &E : index) {
+		size = _align_payload(size) + _get_payload_size(E.key.volume);
+	}
+	for (const KeyValue<NoiseTileKey, LocalVector<uint8_t>> &E : pending) {
+		size = _align_payload(size) + E.value.size();
+	}
+	return size + (uint64_t(index.size() + pending.size()) * INDEX_ENTRY_SIZE);
+}
+
+void NoiseTileStore::_append(const Ref<FileAccess> &p_file, uint64_t p_position) {
+	p_file->seek(p_position);
+	static const uint8_t padding[PAYLOAD_ALIGNMENT] = {};
+	for (const KeyValue<NoiseTileKey, LocalVector<uint8_t>> &E : pending) {
+		const uint64_t aligned = _align_payload(p_position);
+		p_file->store_buffer(padding, aligned - p_position);
+		p_file->store_buffer(E.value.ptr(), E.value.size());
+		index.insert(E.key, aligned);
+		p_position = aligned + E.value.size();
+	}
+	pending.clear();
+
+	const uint64_t index_offset = p_position;
+	for (const KeyValue<NoiseTileKey, uint64_t> &E : index) {
+		p_file->store_32(E.key.x);
+		p_file->store_32(E.key.y);
+		p_file->store_32(E.key.z);
+		p_file->store_32(E.key.lod);
+		p_file->store_32(E.key.volume ? 1 : 0);
+		p_file->store_32(0);
+		p_file->store_64(E.value);
+	}
+	file_size = p_file->get_position();
+
+	// The header is written last, the file only refers to the new tiles once it is.
+	p_file->seek(0);
+	p_file->store_32(MAGIC);
+	p_file->store_32(VERSION);
+	p_file->store_64(hash);
+	p_file->store_32(tile_size_2d);
+	p_file->store_32(tile_size_3d);
+	p_file->store_32(format);
+	p_file->store_32(index.size());
+	p_file->store_64(index_offset);
+}
+
+// The stored tiles are copied to a new file, which then replaces the current one.
+Error NoiseTileStore::_compact() {
+	const String temporary = path + ".tmp";
+	Error error = OK;
+	Ref<FileAccess> file = FileAccess::open(temporary, FileAccess::WRITE, &error);
+	ERR_FAIL_COND_V_MSG(file.is_null(), error, vformat("Cannot write the noise tile store '%s'.", temporary));
+	const uint8_t header[HEADER_SIZE] = {};
+	file->store_buffer(header, HEADER_SIZE);
+
+	static const uint8_t padding[PAYLOAD_ALIGNMENT] = {};
+	HashMap<NoiseTileKey, uint64_t, NoiseTileKeyHasher> kept;
+	LocalVector<uint8_t> payload;
+	uint64_t position = HEADER_SIZE;
+	for (const KeyValue<NoiseTileKey, uint64_t> &E : index) {
+		payload.resize(_get_payload_size(E.key.volume));
+		if (mapping) {
+			memcpy(payload.ptr(), mapping + E.value, payload.size());
+		} else if (reader.is_valid()) {
+			reader->seek(E.value);
+			if (reader->get_buffer(payload.ptr(), payload.size()) != payload.size()) {
+				continue;
+			}
+		} else {
+			continue;
+		}
+		const uint64_t aligned = _align_payload(position);
+		file->store_buffer(padding, aligned - position);
+		file->store_buffer(payload.ptr(), payload.size());
+		kept.insert(E.key, aligned);
+		position = aligned + payload.size();
+	}
+
+	_unmap();
+	index = kept;
+	_append(file, position);
+	file->close();
+	error = DirAccess::create_for_path(path)->rename(temporary, path);
+	if (error != OK) {
+		// The previous file is left as it was.
+		index.clear();
+		file_size = 0;
+		_read_index();
+		_map();
+		ERR_FAIL_V_MSG(error, vformat("Cannot replace the noise tile store '%s'.", path));
+	}
+	_map();
+	return OK;
+}
+
+bool NoiseTileStore::is_open() const {
+	MutexLock lock(mutex);
+	return !path.is_empty();
+}
+
+int NoiseTileStore::get_tile_count() const {
+	MutexLock lock(mutex);
+	return index.size() + pending.size();
+}
+
+bool NoiseTileStore::load(const NoiseTileKey &p_key, uint32_t p_size, float *r_values) const {
+	MutexLock lock(mutex);
+	if (p_size != (p_key.volume ? tile_size_3d : tile_size_2d)) {
+		return false;
+	}
+	const uint8_t *payload = nullptr;
+	LocalVector<uint8_t> buffer;
+	const LocalVector<uint8_t> *stored = pending.getptr(p_key);
+	const uint64_t *offset = index.getptr(p_key);
+	if (stored) {
+		payload = stored->ptr();
+	} else if (offset && mapping) {
+		payload = mapping + *offset;
+	} else if (offset && reader.is_valid()) {
+		buffer.resize(_get_payload_size(p_key.volume));
+		reader->seek(*offset);
+		if (reader->get_buffer(buffer.ptr(), buffer.size()) != buffer.size()) {
+			return false;
+		}
+		payload = buffer.ptr();
+	} else {
+		return false;
+	}
+
+	const uint32_t count = _get_value_count(p_key.volume);
+	if (format == FORMAT_FLOAT16) {
+		const uint16_t *values = reinterpret_cast<const uint16_t *>(payload);
+		for (uint32_t i = 0; i < count; ++i) {
+			r_values[i] = Math::half_to_float(values[i]);
+		}
+	} else {
+		memcpy(r_values, payload, count * sizeof(float));
+	}
+	return true;
+}
+
+void NoiseTileStore::store(const NoiseTileKey &p_key, const float *p_values) {
+	MutexLock lock(mutex);
+	if (path.is_empty() || index.has(p_key) || pending.has(p_key)) {
+		return;
+	}
+	const uint32_t count = _get_value_count(p_key.volume);
+	LocalVector<uint8_t> payload;
+	payload.resize(_get_payload_size(p_key.volume));
+	if (format == FORMAT_FLOAT16) {
+		uint16_t *values = reinterpret_cast<uint16_t *>(payload.ptr());
+		for (uint32_t i = 0; i < count; ++i) {
+			values[i] = Math::make_half_float(p_values[i]);
+		}
+	} else {
+		memcpy(payload.ptr(), p_values, count * sizeof(float));
+	}
+	pending.insert(p_key, payload);
+}
+
+uint32_t NoiseTileStore::_get_value_count(bool p_volume) const {
+	return p_volume ? tile_size_3d * tile_size_3d * tile_size_3d : tile_size_2d * tile_size_2d;
+}
+
+uint32_t NoiseTileStore::_get_payload_size(bool p_volume) const {
+	return _get_value_count(p_volume) * (format == FORMAT_FLOAT16 ? sizeof(uint16_t) : sizeof(float));
+}
+
+void NoiseTileStore::_read_index() {
+	Ref<FileAccess> file = FileAccess::open(path, FileAccess::READ);
+	if (file.is_null() || file->get_length() < HEADER_SIZE) {
+		return;
+	}
+	// Files written for another graph or other settings are replaced on the next flush.
+	const uint64_t length = file->get_length();
+	if (file->get_32() != MAGIC || file->get_32() != VERSION || file->get_64() != hash || file->get_32() != tile_size_2d || file->get_32() != tile_size_3d || file->get_32() != uint32_t(format)) {
+		return;
+	}
+	const uint32_t count = file->get_32();
+	const uint64_t index_offset = file->get_64();
+	ERR_FAIL_COND_MSG(index_offset + (uint64_t(count) * INDEX_ENTRY_SIZE) > length, vformat("Truncated noise tile store '%s', it will be rewritten.", path));
+	file->seek(index_offset);
+	for (uint32_t i = 0; i < count; ++i) {
+		NoiseTileKey key;
+		key.x = int32_t(file->get_32());
+		key.y = int32_t(file->get_32());
+		key.z = int32_t(file->get_32());
+		key.lod = int32_t(file->get_32());
+		key.volume = file->get_32() != 0;
+		file->get_32();
+		const uint64_t offset = file->get_64();
+		if (offset % PAYLOAD_ALIGNMENT != 0 || offset + _get_payload_size(key.volume) > index_offset) {
+			index.clear();
+			ERR_FAIL_MSG(vformat("Corrupted noise tile store '%s', it will be rewritten.", path));
+		}
+		index.insert(key, offset);
+	}
+	file_size = length;
+}
+
+void NoiseTileStore::_map() {
+	if (file_size == 0) {
+		return;
+	}
+#ifdef UNIX_ENABLED
+	const CharString absolute = ProjectSettings::get_singleton()->globalize_path(path).utf8();
+	const int descriptor = ::open(absolute.get_data(), O_RDONLY);
+	if (descriptor >= 0) {
+		void *address = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, descriptor, 0);
+		::close(descriptor);
+		if (address != MAP_FAILED) {
+			mapping = static_cast<const uint8_t *>(address);
+			return;
+		}
+	}
+#endif
+	reader = FileAccess::open(path, FileAccess::READ);
+}
+
+void NoiseTileStore::_unmap() {
+#ifdef UNIX_ENABLED
+	if (mapping) {
+		munmap(const_cast<uint8_t *>(mapping), file_size);
+	}
+#endif
+	mapping = nullptr;
+	reader.unref();
+}
+
+void NoiseTileStore::_reset() {
+	_unmap();
+	index.clear();
+	pending.clear();
+	file_size = 0;
+}
@@ -0,0 +1,125 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_TILE_STORE_H
+#define NOISE_TILE_STORE_H
+
+#include "core/io/file_access.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include <cstdint>
+
+// Tile of a noise: its coordinates on the lattice of its level of detail, and whether it is a 3D tile.
+struct NoiseTileKey {
+	int32_t x{ 0 };
+	int32_t y{ 0 };
+	int32_t z{ 0 };
+	int32_t lod{ 0 };
+	bool volume{ false };
+
+	bool operator==(const NoiseTileKey &p_other) const {
+		return x == p_other.x && y == p_other.y && z == p_other.z && lod == p_other.lod && volume == p_other.volume;
+	}
+};
+
+struct NoiseTileKeyHasher {
+	static uint32_t hash(const NoiseTileKey &p_key);
+};
+
+// File of tiles sampled from a noise graph, reused as long as the graph and the tile settings are unchanged.
+// Layout, little endian:
+// - header, HEADER_SIZE bytes: magic, version, structure hash of the graph, 2D and 3D tile sizes, format of the
+//   values, tile count and offset of the index;
+// - payloads, each aligned on PAYLOAD_ALIGNMENT bytes, as float32 or float16 values;
+// - index, INDEX_ENTRY_SIZE bytes per tile: x, y, z, level of detail, 1 for 3D tiles, 0, offset of the payload.
+// The file is memory mapped where supported, and read through FileAccess otherwise. New tiles are kept in memory
+// until flushed. They are then appended with a new index, and the header is rewritten last, so that an
+// interrupted flush leaves the previous content intact. Once the indices left behind outweigh the tiles, the
+// flush writes a compacted copy instead, which replaces the file when complete.
+class NoiseTileStore {
+public:
+	enum Format {
+		FORMAT_FLOAT32,
+		// Half the size, with about 3 significant digits: tiles loaded back differ from the source by up to
+		// 1/2048 of their magnitude.
+		FORMAT_FLOAT16,
+	};
+
+	static constexpr uint32_t MAGIC = 0x5354434E; // "NCTS"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t HEADER_SIZE = 64;
+	static constexpr uint32_t INDEX_ENTRY_SIZE = 32;
+	static constexpr uint32_t PAYLOAD_ALIGNMENT = 64;
+
+public:
+	NoiseTileStore() {}
+	~NoiseTileStore() { close(); }
+
+	// Uses the file at the path, keeping its tiles if it was written for the same graph and settings. The
+	// tiles not flushed yet are written first when the path changes, and dropped otherwise.
+	void open(const String &p_path, uint64_t p_hash, uint32_t p_tile_size_2d, uint32_t p_tile_size_3d, Format p_format);
+	// Flushes the new tiles and releases the file.
+	void close();
+	Error flush();
+	// Forgets the tiles not flushed yet, sampled from a state of the graph that no longer holds.
+	void drop_pending();
+
+	bool is_open() const;
+	int get_tile_count() const;
+
+	// Fails when the tiles of the store are not p_size values wide.
+	bool load(const NoiseTileKey &p_key, uint32_t p_size, float *r_values) const;
+	void store(const NoiseTileKey &p_key, const float *p_values);
+
+private:
+	uint32_t _get_value_count(bool p_volume) const;
+	uint32_t _get_payload_size(bool p_volume) const;
+	void _read_index();
+	void _map();
+	void _unmap();
+	void _reset();
+	// Size the file would have if it was written from scratch.
+	uint64_t _get_live_size() const;
+	// Appends the pending tiles, the index and the header, the file being positioned at its end.
+	void _append(const Ref<FileAccess> &p_file, uint64_t p_position);
+	Error _compact();
+
+private:
+	String path;
+	uint64_t hash{ 0 };
+	uint32_t tile_size_2d{ 0 };
+	uint32_t tile_size_3d{ 0 };
+	Format format{ FORMAT_FLOAT32 };
+
+	// Offsets of the payloads in the file.
+	HashMap<NoiseTileKey, uint64_t, NoiseTileKeyHasher> index;
+	HashMap<NoiseTileKey, LocalVector<uint8_t>, NoiseTileKeyHasher> pending;
+	// Size of the file, 0 when it has to be written from scratch.
+	uint64_t file_size{ 0 };
+	const uint8_t *mapping{ nullptr };
+	Ref<FileAccess> reader;
+	mutable Mutex mutex;
+};
+
+#endif
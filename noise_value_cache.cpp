@@ -0,0 +1,160 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "noise_value_cache.h"
+#include "core/templates/hashfuncs.h"
+#include <cmath>
+#include <cstring>
+
+void NoiseValueCache::configure(int p_capacity, Eviction p_eviction, real_t p_quantization) {
+	// Every shard is locked at once, so that lookups and stores see either the old or the new configuration.
+	// The generation changes meanwhile, so that keys made with the old quantization never match.
+	for (Shard &shard : shards) {
+		shard.lock.lock();
+	}
+	capacity = MAX(p_capacity, 0);
+	eviction = p_eviction;
+	quantization.store(MAX(p_quantization, (real_t)0.), std::memory_order_relaxed);
+	sets_per_shard = (capacity + (SHARD_COUNT * WAYS) - 1) / (SHARD_COUNT * WAYS);
+	for (Shard &shard : shards) {
+		shard.entries.clear();
+		shard.entries.resize(sets_per_shard * WAYS);
+		shard.tick = 0;
+	}
+	invalidate();
+	for (Shard &shard : shards) {
+		shard.lock.unlock();
+	}
+}
+
+bool NoiseValueCache::_make_key(int p_dimension, const Vector3 &p_coord, Key &r_key) const {
+	r_key.dimension = p_dimension;
+	const real_t quantization = get_quantization();
+	for (int i = 0; i < p_dimension; ++i) {
+		if (quantization > 0.) {
+			const double cell = std::floor((double)p_coord[i] / quantization);
+			// Out of the int64 range, or NaN.
+			if (!(cell >= -0x1p63 && cell < 0x1p63)) {
+				return false;
+			}
+			r_key.coord[i] = (int64_t)cell;
+		} else {
+			// Exact coordinates, with both zeroes sharing the same key.
+			real_t c = p_coord[i] == 0. ? 0. : p_coord[i];
+			std::memcpy(&r_key.coord[i], &c, sizeof(real_t));
+		}
+	}
+	uint32_t hash = hash_murmur3_one_32(p_dimension);
+	for (int i = 0; i < 3; ++i) {
+		hash = hash_murmur3_one_64(r_key.coord[i], hash);
+	}
+	r_key.hash = hash_fmix32(hash);
+	return true;
+}
+
+bool NoiseValueCache::lookup(int p_dimension, const Vector3 &p_coord, real_t &r_value, uint32_t &r_generation) {
+	// Read before the key is made, a configuration changing the quantization meanwhile changes it.
+	const uint32_t current = generation.load(std::memory_order_acquire);
+	r_generation = current;
+	Key key;
+	if (!_make_key(p_dimension, p_coord, key)) {
+		shards[0].misses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	Shard &shard = shards[key.hash % SHARD_COUNT];
+	bool found = false;
+
+	shard.lock.lock();
+	if (sets_per_shard == 0 || generation.load(std::memory_order_acquire) != current) {
+		shard.lock.unlock();
+		shard.misses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	Entry *set = shard.entries.ptr() + (((key.hash / SHARD_COUNT) % sets_per_shard) * WAYS);
+	for (int i = 0; i < WAYS; ++i) {
+		Entry &entry = set[i];
+		if (entry.used && entry.generation == current && entry.key == key) {
+			if (eviction == EVICTION_LRU) {
+				entry.stamp = ++shard.tick;
+			}
+			r_value = entry.value;
+			found = true;
+			break;
+		}
+	}
+	shard.lock.unlock();
+
+	(found ? shard.hits : shard.misses).fetch_add(1, std::memory_order_relaxed);
+	return found;
+}
+
+void NoiseValueCache::store(int p_dimension, const Vector3 &p_coord, real_t p_value, uint32_t p_generation) {
+	Key key;
+	if (!_make_key(p_dimension, p_coord, key)) {
+		return;
+	}
+	Shard &shard = shards[key.hash % SHARD_COUNT];
+
+	shard.lock.lock();
+	// The value was computed for entries the cache dropped since.
+	const uint32_t current = generation.load(std::memory_order_acquire);
+	if (sets_per_shard == 0 || current != p_generation) {
+		shard.lock.unlock();
+		return;
+	}
+	Entry *set = shard.entries.ptr() + (((key.hash / SHARD_COUNT) % sets_per_shard) * WAYS);
+	// Free or stale entries first, then the oldest one according to the eviction policy.
+	Entry *victim = &set[0];
+	for (int i = 0; i < WAYS; ++i) {
+		Entry &entry = set[i];
+		if (!entry.used || entry.generation != current || entry.key == key) {
+			victim = &entry;
+			break;
+		}
+		if (entry.stamp < victim->stamp) {
+			victim = &entry;
+		}
+	}
+	victim->key = key;
+	victim->value = p_value;
+	victim->generation = current;
+	victim->stamp = ++shard.tick;
+	victim->used = true;
+	shard.lock.unlock();
+}
+
+uint64_t NoiseValueCache::get_hits() const {
+	uint64_t total = 0;
+	for (const Shard &shard : shards) {
+		total += shard.hits.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+uint64_t NoiseValueCache::get_misses() const {
+	uint64_t total = 0;
+	for (const Shard &shard : shards) {
+		total += shard.misses.load(std::memory_order_relaxed);
+	}
+	return total;
+}
@@ -0,0 +1,104 @@
+/**************************************************************************/
+/* No Copyright, CC0                                                      */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NOISE_VALUE_CACHE_H
+#define NOISE_VALUE_CACHE_H
+
+#include "core/math/vector3.h"
+#include "core/os/spin_lock.h"
+#include "core/templates/local_vector.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Memoization of sampled values, shared between threads.
+// Entries are spread over independently locked shards, each of them a set-associative table. Coordinates
+// can be quantized, in which case every coordinate of a cell shares the value first stored for that cell.
+class NoiseValueCache {
+public:
+	enum Eviction {
+		EVICTION_LRU,
+		EVICTION_FIFO,
+	};
+
+	static constexpr int SHARD_COUNT = 16;
+	static constexpr int WAYS = 4;
+
+	NoiseValueCache() {}
+
+	// Drops every entry. Safe while other threads look values up or store them.
+	void configure(int p_capacity, Eviction p_eviction, real_t p_quantization);
+	int get_capacity() const { return capacity; }
+	Eviction get_eviction() const { return eviction; }
+	real_t get_quantization() const { return quantization.load(std::memory_order_relaxed); }
+
+	// Drops every entry, in constant time.
+	void invalidate() { generation.fetch_add(1, std::memory_order_release); }
+
+	// On a miss, r_generation is the generation to pass to store() along with the value once computed, so
+	// that a value computed before an invalidation is not stored after it. Coordinates whose quantized cell
+	// is not representable, such as NaN or infinite ones, always miss and are never stored.
+	bool lookup(int p_dimension, const Vector3 &p_coord, real_t &r_value, uint32_t &r_generation);
+	void store(int p_dimension, const Vector3 &p_coord, real_t p_value, uint32_t p_generation);
+
+	uint64_t get_hits() const;
+	uint64_t get_misses() const;
+
+private:
+	struct Key {
+		std::array<int64_t, 3> coord{ { 0, 0, 0 } };
+		int dimension{ 0 };
+		uint32_t hash{ 0 };
+
+		bool operator==(const Key &p_other) const { return dimension == p_other.dimension && coord == p_other.coord; }
+	};
+
+	struct Entry {
+		Key key;
+		real_t value{ 0. };
+		uint32_t generation{ 0 };
+		uint32_t stamp{ 0 };
+		bool used{ false };
+	};
+
+	struct Shard {
+		SpinLock lock;
+		LocalVector<Entry> entries;
+		uint32_t tick{ 0 };
+		std::atomic<uint64_t> hits{ 0 };
+		std::atomic<uint64_t> misses{ 0 };
+	};
+
+	bool _make_key(int p_dimension, const Vector3 &p_coord, Key &r_key) const;
+
+private:
+	std::array<Shard, SHARD_COUNT> shards;
+	std::atomic<uint32_t> generation{ 1 };
+	int capacity{ 0 };
+	// Only changed with every shard locked.
+	int sets_per_shard{ 0 };
+	Eviction eviction{ EVICTION_LRU };
+	std::atomic<real_t> quantization{ 0. };
+};
+
+#endif
@@ -24,8 +24,12 @@
 #include "register_types.h"
 
 #include "core/object/class_db.h"
+#include "noise_baked.h"
+#include "noise_benchmark.h"
 #include "noise_composer.h"
+#include "noise_program.h"
 #include "noise_seeder.h"
+#include "noise_tile_cache.h"
 #include "visual_noise.h"
 
 #ifdef TOOLS_ENABLED
@@ -50,11 +54,21 @@ void initialize_noise_composer_module(ModuleInitializationLevel p_level) {
 		GDREGISTER_CLASS(AffineNoise);
 		GDREGISTER_CLASS(MixNoise);
 		GDREGISTER_CLASS(SelectNoise);
+		GDREGISTER_ABSTRACT_CLASS(NoiseArrayOperator);
+		GDREGISTER_CLASS(MultiAddNoise);
+		GDREGISTER_CLASS(MultiMultiplyNoise);
+		GDREGISTER_CLASS(MultiMaxNoise);
+		GDREGISTER_CLASS(MultiMinNoise);
+		GDREGISTER_CLASS(WeightedSumNoise);
 		GDREGISTER_CLASS(NoiseProxy);
 		GDREGISTER_CLASS(LinearTransformNoise);
 		GDREGISTER_CLASS(RescalerNoise);
+		GDREGISTER_CLASS(CompiledNoise);
+		GDREGISTER_CLASS(BakedNoise);
+		GDREGISTER_CLASS(NoiseTileCache);
 
 		GDREGISTER_CLASS(NoiseSeeder);
+		GDREGISTER_CLASS(NoiseBenchmark);
 
 		// Visual classes
 		//GDREGISTER_CLASS(VisualNoise);